@@ -5,5 +5,17 @@ for mode in none on-off laser full
 do
 # ./wyy_simulator --activate-dlps --cfg=network/crosstraffic:0 --cfg=surf/precision:1.0e-15 --log=wyy_simulator.th:info --log=wyy_wms.th:info --log=wyy_wms.fmt:%m --log=wyy_wms.app:file:output/task_execution_${mode}.csv --log=dlps.th:info --log=dlps.fmt:%m --log=dlps.app:file:output/dlps_events_${mode}.csv --cfg=contexts/guard-size:0 platforms/cluster_64_machines_FAT_TREE.xml ../instance_trace_to_workflows/original/output/swf/container_trace.swf ../instance_trace_to_workflows/spar_sampled/workflows/64_machines/ 4096 0.5 static --cfg=network/dlps:${mode}
 
+# With the container trace of the same hour window as background load:
+# ./wyy_simulator --activate-dlps --cfg=network/crosstraffic:0 --cfg=surf/precision:1.0e-15 --log=wyy_simulator.th:info --cfg=contexts/guard-size:0 --cfg=network/optim:Full platforms/cluster_16_machines_FAT_TREE.xml ../instance_trace_to_workflows/original/output/swf/ ../instance_trace_to_workflows/original/output/workflows_without_file_size/0-1/ 16 0.5 static --cfg=network/dlps:${mode} --log=wyy_wms.th:info --log=wyy_wms.fmt:%m --log=wyy_wms.app:file:output/task_execution_${mode}.csv --log=dlps.th:info --log=dlps.fmt:%m --log=dlps.app:file:output/dlps_events_${mode}.csv --background-load
+
+# With one batch service per pod (the pod_size prop of the platform), placing each task in the pod of its parents:
+# ./wyy_simulator --activate-dlps --cfg=network/crosstraffic:0 --cfg=surf/precision:1.0e-15 --log=wyy_simulator.th:info --cfg=contexts/guard-size:0 --cfg=network/optim:Full platforms/cluster_16_machines_FAT_TREE.xml ../instance_trace_to_workflows/original/output/swf/ ../instance_trace_to_workflows/original/output/workflows_without_file_size/0-1/ 16 0.5 static --cfg=network/dlps:${mode} --log=wyy_wms.th:info --log=wyy_wms.fmt:%m --log=wyy_wms.app:file:output/task_execution_${mode}.csv --log=dlps.th:info --log=dlps.fmt:%m --log=dlps.app:file:output/dlps_events_${mode}.csv --background-load --pod-locality
+
+# Submitting each single-parent, single-child chain of tasks as one job, with the files passed along it on scratch:
+# ./wyy_simulator --activate-dlps --cfg=network/crosstraffic:0 --cfg=surf/precision:1.0e-15 --log=wyy_simulator.th:info --cfg=contexts/guard-size:0 --cfg=network/optim:Full platforms/cluster_16_machines_FAT_TREE.xml ../instance_trace_to_workflows/original/output/swf/ ../instance_trace_to_workflows/original/output/workflows_without_file_size/0-1/ 16 0.5 static --cfg=network/dlps:${mode} --log=wyy_wms.th:info --log=wyy_wms.fmt:%m --log=wyy_wms.app:file:output/task_execution_${mode}.csv --log=dlps.th:info --log=dlps.fmt:%m --log=dlps.app:file:output/dlps_events_${mode}.csv --background-load --chain-jobs
+
+# Packing the ready tasks of each workflow onto as few nodes as fit them, gathering events for up to 1 s before each pass (which delays the tasks made ready first):
+# ./wyy_simulator --activate-dlps --cfg=network/crosstraffic:0 --cfg=surf/precision:1.0e-15 --log=wyy_simulator.th:info --cfg=contexts/guard-size:0 --cfg=network/optim:Full platforms/cluster_16_machines_FAT_TREE.xml ../instance_trace_to_workflows/original/output/swf/ ../instance_trace_to_workflows/original/output/workflows_without_file_size/0-1/ 16 0.5 static --cfg=network/dlps:${mode} --log=wyy_wms.th:info --log=wyy_wms.fmt:%m --log=wyy_wms.app:file:output/task_execution_${mode}.csv --log=dlps.th:info --log=dlps.fmt:%m --log=dlps.app:file:output/dlps_events_${mode}.csv --background-load --pack-jobs=1
+
 ./wyy_simulator --activate-dlps --cfg=network/crosstraffic:0 --cfg=surf/precision:1.0e-15 --log=wyy_simulator.th:info --cfg=contexts/guard-size:0 --cfg=network/optim:Full platforms/cluster_16_machines_FAT_TREE.xml ../instance_trace_to_workflows/original/output/swf/container_trace.swf ../instance_trace_to_workflows/original/output/workflows_without_file_size/0-1/ 16 0.5 static --cfg=network/dlps:${mode} --log=wyy_wms.th:info --log=wyy_wms.fmt:%m --log=wyy_wms.app:file:output/task_execution_${mode}.csv --log=dlps.th:info --log=dlps.fmt:%m --log=dlps.app:file:output/dlps_events_${mode}.csv
 done
@@ -9,6 +9,7 @@
  */
 
 #include <math.h>
+#include <algorithm>
 #include "BatchStandardJobScheduler.h"
 
 WRENCH_LOG_CATEGORY(batch_scheduler, "Log category for Batch Scheduler");
@@ -27,7 +28,7 @@ namespace wrench {
                                                   const std::vector<WorkflowTask *> &tasks) {
 
       // Check that the right compute_services is passed
-      if (compute_services.size() != 1) {
+      if (compute_services.size() != 1 and pod_services.empty()) {
         throw std::runtime_error("This example Batch Scheduler requires a single compute service");
       }
 
@@ -40,29 +41,280 @@ namespace wrench {
 
       WRENCH_INFO("There are %ld ready tasks to schedule", tasks.size());
 
+      // With pod locality, the cores of each pod, counted on the first pass of any workflow. Only the
+      // jobs of the workflows are taken off and given back, the background jobs of the trace are left
+      // to the batch queues of the pods.
+      if (free_cores->empty()) {
+        for (auto pod_service : pod_services) {
+          double pod_cores = 0;
+          for (auto const &h : pod_service->getPerHostNumCores()) pod_cores += h.second;
+          free_cores->push_back(pod_cores);
+        }
+      }
+
+      // With job packing, the units of each pod, packed once all of them are known
+      std::vector<std::vector<std::vector<WorkflowTask *>>> pod_units(max((size_t) 1, pod_services.size()));
+
       for (auto task : tasks) {
-        //TODO add support to pilot jobs
+        std::vector<WorkflowTask *> unit = chain_jobs ? getChain(task) : std::vector<WorkflowTask *>{task};
+        int num_cores = getNumCores(unit);
+        int pod = 0;
+        if (not pod_services.empty()) {
+          pod = selectPod(unit, num_cores);
+          batch_service = pod_services[pod];
+        }
+        if (pilot_pool) {
+          pod_units[pod].push_back(unit);
+        } else {
+          submitUnit(unit, num_cores, pod, batch_service);
+        }
+      }
+
+      for (size_t p = 0; p < pod_units.size(); p++) {
+        packUnits(pod_units[p], p, pod_services.empty() ? batch_service : pod_services[p]);
+      }
+      WRENCH_INFO("Done with scheduling tasks as standard jobs");
+    }
+
+    /**
+     * @brief The chain that starts at a ready task: the task, its only child if the task is
+     *        that child's only parent, and so on
+     *
+     * @param task: a ready task
+     *
+     * @return the tasks of the chain, in order
+     */
+    std::vector<WorkflowTask *> BatchStandardJobScheduler::getChain(WorkflowTask *task) {
+      std::vector<WorkflowTask *> chain = {task};
+      while (chain.back()->getNumberOfChildren() == 1) {
+        auto child = chain.back()->getChildren().front();
+        if (child->getNumberOfParents() != 1) break;
+        chain.push_back(child);
+      }
+      return chain;
+    }
+
+    /**
+     * @brief The number of cores of a unit, whose tasks run one after the other
+     *
+     * @param unit: the tasks of a job
+     *
+     * @return ceil(avgCPU/100) of its largest task, at least 1
+     */
+    int BatchStandardJobScheduler::getNumCores(const std::vector<WorkflowTask *> &unit) {
+      int num_cores = 1;
+      for (auto t : unit) {
+        num_cores = max(num_cores, (int) ceil(t->getAverageCPU()/100));
+      }
+      return num_cores;
+    }
+
+    /**
+     * @brief Pack units first-fit decreasing on cores, then memory, into the pilot jobs the
+     *        dispatcher holds for all workflows, each unit as a job of its own. The units
+     *        no pilot job has room for are packed onto new nodes the same way and the units
+     *        of each node go as one batch job, while as many pilot jobs are asked for the
+     *        next passes of any workflow.
+     *
+     * @param units: the units to pack, all for the same pod
+     * @param pod: the pod, 0 without pod locality
+     * @param batch_service: the batch service of the pod
+     */
+    void BatchStandardJobScheduler::packUnits(std::vector<std::vector<WorkflowTask *>> &units, int pod, std::shared_ptr<BatchComputeService> batch_service) {
+      if (units.empty()) return;
+
+      // The largest node bounds a job, asked once per service
+      auto capacity = node_capacity.find(batch_service);
+      if (capacity == node_capacity.end()) {
+        double node_cores = 0;
+        double node_memory = 0;
+        for (auto const &h : batch_service->getPerHostNumCores()) node_cores = max(node_cores, (double) h.second);
+        for (auto const &h : batch_service->getMemoryCapacity()) node_memory = max(node_memory, h.second);
+        capacity = node_capacity.insert(std::make_pair(batch_service, std::make_pair(node_cores, node_memory))).first;
+      }
+      double node_cores = capacity->second.first;
+      double node_memory = capacity->second.second;
+
+      struct Bin {
+        double cores;
+        double memory;
+        std::vector<WorkflowTask *> tasks;
+      };
+      std::vector<std::pair<std::pair<double, double>, std::vector<WorkflowTask *> *>> sorted_units;
+      for (auto &unit : units) {
+        double memory = 0;
+        for (auto t : unit) memory = max(memory, t->getMemoryRequirement());
+        sorted_units.push_back(std::make_pair(std::make_pair((double) getNumCores(unit), memory), &unit));
+      }
+      std::stable_sort(sorted_units.begin(), sorted_units.end(),
+                       [](const decltype(sorted_units)::value_type &a, const decltype(sorted_units)::value_type &b) { return a.first > b.first; });
+
+      std::vector<Bin> bins;
+      unsigned long num_in_pilots = 0;
+      for (auto const &u : sorted_units) {
+        double cores = u.first.first;
+        double memory = u.first.second;
+
+        auto pilot = pilot_pool->place(pod, cores, memory);
+        if (pilot) {
+          auto job = createJob(*u.second);
+          std::map<std::string, std::string> pilot_job_args;
+          for (auto t : *u.second) {
+            pilot_job_args[t->getID()] = std::to_string((int) cores);
+          }
+          this->getJobManager()->submitJob(job, pilot->compute_service, pilot_job_args);
+          pilot_units[u.second->front()] = std::make_tuple(pilot, cores, memory);
+          num_in_pilots++;
+          continue;
+        }
+
+        auto bin = std::find_if(bins.begin(), bins.end(), [&](const Bin &b) {
+          return b.cores + cores <= node_cores and b.memory + memory <= node_memory;
+        });
+        if (bin == bins.end()) {
+          bins.push_back({0, 0, {}});
+          bin = bins.end() - 1;
+        }
+        bin->cores += cores;
+        bin->memory += memory;
+        bin->tasks.insert(bin->tasks.end(), u.second->begin(), u.second->end());
+      }
+
+      WRENCH_INFO("Packed %lu units into pilot jobs and %lu units into %lu jobs", num_in_pilots, units.size() - num_in_pilots, bins.size());
+      for (auto &bin : bins) {
+        submitUnit(bin.tasks, (int) bin.cores, pod, batch_service);
+      }
+      if (not bins.empty()) {
+        pilot_pool->requestPilots(pod, bins.size());
+      }
+    }
 
-        std::map<WorkflowFile *, std::shared_ptr<FileLocation>> file_locations;
+    /**
+     * @brief Create one standard job for tasks that run on one node. The files one of them
+     *        writes for another stay on the scratch space of the job, the others are read
+     *        from the storage service of the host that wrote them and written to the master
+     *
+     * @param unit: tasks in dependency order, the first one ready
+     *
+     * @return the job
+     */
+    std::shared_ptr<StandardJob> BatchStandardJobScheduler::createJob(const std::vector<WorkflowTask *> &unit) {
+
+      std::set<WorkflowTask *> unit_tasks(unit.begin(), unit.end());
+      std::map<WorkflowFile *, std::shared_ptr<FileLocation>> file_locations;
+      for (auto task : unit) {
         for (auto f : task->getInputFiles()) {
 	  std::string local_host = "";
 	  if (f->isOutput()){
+	    if (unit_tasks.find(f->getOutputOf()) != unit_tasks.end()) {
+	      file_locations[f] = FileLocation::SCRATCH;
+	      continue;
+	    }
 	    local_host = f->getOutputOf()->getExecutionHost();
 	  }
           file_locations[f] = wrench::FileLocation::LOCATION(local_host.empty() ? hostname_to_storage_service[this->getJobManager()->getHostname()] : hostname_to_storage_service[local_host]);
         }
+      }
+      for (auto task : unit) {
         for (auto f : task->getOutputFiles()) {
-          file_locations[f] = wrench::FileLocation::LOCATION(hostname_to_storage_service["master"]);
+          if (file_locations.find(f) == file_locations.end()) {
+            file_locations[f] = wrench::FileLocation::LOCATION(hostname_to_storage_service["master"]);
+          }
         }
+      }
+
+      return this->getJobManager()->createStandardJob(unit, file_locations);
+    }
 
-        auto job = this->getJobManager()->createStandardJob(task, file_locations);
-        std::map<std::string, std::string> batch_job_args;
-        batch_job_args["-N"] = "1";
-        batch_job_args["-t"] = "2000000"; //time in minutes
-        batch_job_args["-c"] = std::to_string(max(1, (int) ceil(task->getAverageCPU()/100))); //number of cores per node
-        this->getJobManager()->submitJob(job, batch_service, batch_job_args);
+    /**
+     * @brief Submit tasks as one batch job on one node, taking its cores off the free cores of its pod
+     *
+     * @param unit: tasks in dependency order, the first one ready
+     * @param num_cores: the number of cores to ask for
+     * @param pod: the pod, 0 without pod locality
+     * @param batch_service: the batch service to submit to
+     */
+    void BatchStandardJobScheduler::submitUnit(const std::vector<WorkflowTask *> &unit, int num_cores, int pod, std::shared_ptr<BatchComputeService> batch_service) {
+
+      auto job = createJob(unit);
+      std::map<std::string, std::string> batch_job_args;
+      batch_job_args["-N"] = "1";
+      batch_job_args["-t"] = "2000000"; //time in minutes
+      batch_job_args["-c"] = std::to_string(num_cores); //number of cores per node
+      this->getJobManager()->submitJob(job, batch_service, batch_job_args);
+      if (not pod_services.empty()) {
+        (*free_cores)[pod] -= num_cores;
+        taken_cores[unit.front()] = std::make_pair(pod, num_cores);
+      }
+      if (unit.size() > 1) {
+        WRENCH_DEBUG("Submitted %lu tasks from %s as one job", unit.size(), unit.front()->getID().c_str());
+      }
+    }
+
+    /**
+     * @brief Pick the pod of a unit: the one whose nodes wrote most of the bytes its tasks
+     *        read from outside the unit, where they are read from, if it has the cores free,
+     *        or else the pod with the most free cores. The batch service of the pod picks
+     *        the node.
+     *
+     * @param unit: the tasks of a job, the first one ready
+     * @param num_cores: the number of cores the unit asks for
+     *
+     * @return the index of the pod
+     */
+    int BatchStandardJobScheduler::selectPod(const std::vector<WorkflowTask *> &unit, double num_cores) {
+
+      auto &free_cores = *this->free_cores;
+      auto task = unit.front();
+      std::set<WorkflowTask *> unit_tasks(unit.begin(), unit.end());
+      std::map<int, double> parent_pods;
+      for (auto t : unit) {
+        for (auto f : t->getInputFiles()) {
+          if (not f->isOutput() or unit_tasks.find(f->getOutputOf()) != unit_tasks.end()) continue;
+          auto itp = host_to_pod.find(f->getOutputOf()->getExecutionHost());
+          if (itp != host_to_pod.end()) {
+            parent_pods[itp->second] += f->getSize();
+          }
+        }
+      }
+
+      int pod = -1;
+      for (auto const &p : parent_pods) {
+        if (pod < 0 or p.second > parent_pods[pod]) pod = p.first;
+      }
+
+      // Least-loaded pod
+      if (pod < 0 or free_cores[pod] < num_cores) {
+        pod = 0;
+        for (int p = 1; p < (int) free_cores.size(); p++) {
+          if (free_cores[p] > free_cores[pod]) pod = p;
+        }
+      }
+
+      WRENCH_DEBUG("Task %s goes to pod %d (%lu parent pods)", task->getID().c_str(), pod, parent_pods.size());
+
+      return pod;
+    }
+
+    /**
+     * @brief Give back the cores taken for the units of a job that has ended, in its pod
+     *        or in its pilot job
+     *
+     * @param job: a completed or failed standard job
+     */
+    void BatchStandardJobScheduler::releaseCores(const std::shared_ptr<StandardJob> &job) {
+      for (auto task : job->getTasks()) {
+        auto it = taken_cores.find(task);
+        if (it != taken_cores.end()) {
+          (*free_cores)[it->second.first] += it->second.second;
+          taken_cores.erase(it);
+        }
+        auto itp = pilot_units.find(task);
+        if (itp != pilot_units.end()) {
+          pilot_pool->release(std::get<0>(itp->second), std::get<1>(itp->second), std::get<2>(itp->second));
+          pilot_units.erase(itp);
+        }
       }
-      WRENCH_INFO("Done with scheduling tasks as standard jobs");
     }
 
 }
@@ -12,6 +12,7 @@
 #define WRENCH_EXAMPLE_BATCHSTANDARDJOBSCHEDULER_H
 
 #include <wrench-dev.h>
+#include "PilotJobPool.h"
 
 namespace wrench {
 
@@ -22,8 +23,19 @@ namespace wrench {
 
     public:
 
-        explicit BatchStandardJobScheduler(std::map<std::string, std::shared_ptr<StorageService>> &hostname_to_storage_service) :
-                hostname_to_storage_service(hostname_to_storage_service) {}
+        /** @brief The cores of each pod not taken by the jobs of the workflows */
+        typedef std::vector<double> PodFreeCores;
+
+        explicit BatchStandardJobScheduler(std::map<std::string, std::shared_ptr<StorageService>> &hostname_to_storage_service,
+                                           const std::map<std::string, int> &host_to_pod = {},
+                                           const std::vector<std::shared_ptr<BatchComputeService>> &pod_services = {},
+                                           std::shared_ptr<PodFreeCores> free_cores = nullptr,
+                                           bool chain_jobs = false,
+                                           std::shared_ptr<PilotJobPool> pilot_pool = nullptr) :
+                hostname_to_storage_service(hostname_to_storage_service), host_to_pod(host_to_pod), pod_services(pod_services),
+                free_cores(free_cores ? free_cores : std::make_shared<PodFreeCores>()), chain_jobs(chain_jobs), pilot_pool(pilot_pool) {}
+
+        void releaseCores(const std::shared_ptr<StandardJob> &job);
 
         /***********************/
         /** \cond DEVELOPER    */
@@ -37,8 +49,44 @@ namespace wrench {
         /***********************/
 
     private:
+        std::vector<WorkflowTask *> getChain(WorkflowTask *task);
+
+        int getNumCores(const std::vector<WorkflowTask *> &unit);
+
+        void packUnits(std::vector<std::vector<WorkflowTask *>> &units, int pod, std::shared_ptr<BatchComputeService> batch_service);
+
+        std::shared_ptr<StandardJob> createJob(const std::vector<WorkflowTask *> &unit);
+
+        void submitUnit(const std::vector<WorkflowTask *> &unit, int num_cores, int pod, std::shared_ptr<BatchComputeService> batch_service);
+
+        int selectPod(const std::vector<WorkflowTask *> &unit, double num_cores);
+
         std::map<std::string, std::shared_ptr<StorageService>> hostname_to_storage_service;
 
+        /** @brief The pod of each compute node, empty without pod locality */
+        std::map<std::string, int> host_to_pod;
+
+        /** @brief The batch service of each pod, empty without pod locality */
+        std::vector<std::shared_ptr<BatchComputeService>> pod_services;
+
+        /** @brief The free cores of the pods, shared by the schedulers of all workflows */
+        std::shared_ptr<PodFreeCores> free_cores;
+
+        /** @brief The pod and cores taken by the first task of each batch job submitted, until the job ends */
+        std::map<WorkflowTask *, std::pair<int, double>> taken_cores;
+
+        /** @brief Whether single-parent, single-child chains go into one job */
+        bool chain_jobs;
+
+        /** @brief The pilot jobs the units of all workflows are packed into, nullptr without job packing */
+        std::shared_ptr<PilotJobPool> pilot_pool;
+
+        /** @brief The pilot job, cores and memory taken by the first task of each unit submitted to one, until its job ends */
+        std::map<WorkflowTask *, std::tuple<std::shared_ptr<PilotJobPool::Pilot>, double, double>> pilot_units;
+
+        /** @brief The cores and memory of the largest node of each batch service */
+        std::map<std::shared_ptr<BatchComputeService>, std::pair<double, double>> node_capacity;
+
     };
 }
 
@@ -0,0 +1,144 @@
+#include <fstream>
+#include <vector>
+#include <cstring>
+
+#include "BinaryWorkflowParser.h"
+#include "WorkflowBinaryFormat.h"
+
+namespace wrench {
+
+    /* Read a whole .wfb file and check its header */
+    static std::vector<char> readWFB(const std::string& filename, wfb::Header& header) {
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (not file) {
+	    throw std::invalid_argument("Cannot open " + filename);
+	}
+	std::vector<char> buffer(file.tellg());
+	file.seekg(0);
+	file.read(buffer.data(), buffer.size());
+
+	if (buffer.size() < sizeof(header)) {
+	    throw std::invalid_argument("Truncated workflow file " + filename);
+	}
+	memcpy(&header, buffer.data(), sizeof(header));
+	if (memcmp(header.magic, wfb::magic, sizeof(header.magic)) != 0) {
+	    throw std::invalid_argument("Not a binary workflow file: " + filename);
+	}
+
+	uint64_t expected_size = sizeof(header)
+	    + header.num_tasks * sizeof(wfb::Task) + header.num_files * sizeof(wfb::File)
+	    + (3 * (header.num_tasks + 1ULL) + header.num_parents + header.num_inputs + header.num_outputs) * sizeof(uint32_t)
+	    + header.string_bytes;
+	if (buffer.size() != expected_size) {
+	    throw std::invalid_argument("Corrupted workflow file " + filename);
+	}
+	return buffer;
+    }
+
+    /**
+     * @brief Create a workflow based on a .wfb file, with the same task and file attributes as the JSON parser
+     *
+     * @param filename: the path to the .wfb file
+     * @param reference_flop_rate: a reference compute speed (in flops/sec), so that task runtimes can be converted into flops
+     *
+     * @return a workflow
+     *
+     * @throw std::invalid_argument
+     */
+    Workflow* BinaryWorkflowParser::createWorkflowFromWFB(const std::string& filename, const std::string& reference_flop_rate) {
+
+	wfb::Header header;
+	std::vector<char> buffer = readWFB(filename, header);
+	double flop_rate = UnitParser::parse_compute_speed(reference_flop_rate);
+
+	const char* position = buffer.data() + sizeof(header);
+	auto take = [&position](size_t bytes) {
+	    const char* array = position;
+	    position += bytes;
+	    return array;
+	};
+	const wfb::Task* tasks = reinterpret_cast<const wfb::Task*>(take(header.num_tasks * sizeof(wfb::Task)));
+	const wfb::File* files = reinterpret_cast<const wfb::File*>(take(header.num_files * sizeof(wfb::File)));
+	const uint32_t* parent_offsets = reinterpret_cast<const uint32_t*>(take((header.num_tasks + 1) * sizeof(uint32_t)));
+	const uint32_t* parents = reinterpret_cast<const uint32_t*>(take(header.num_parents * sizeof(uint32_t)));
+	const uint32_t* input_offsets = reinterpret_cast<const uint32_t*>(take((header.num_tasks + 1) * sizeof(uint32_t)));
+	const uint32_t* inputs = reinterpret_cast<const uint32_t*>(take(header.num_inputs * sizeof(uint32_t)));
+	const uint32_t* output_offsets = reinterpret_cast<const uint32_t*>(take((header.num_tasks + 1) * sizeof(uint32_t)));
+	const uint32_t* outputs = reinterpret_cast<const uint32_t*>(take(header.num_outputs * sizeof(uint32_t)));
+	const char* strings = take(header.string_bytes);
+
+	auto getString = [&](uint32_t offset, uint32_t length) {
+	    if ((uint64_t) offset + length > header.string_bytes) {
+		throw std::invalid_argument("Corrupted workflow file " + filename);
+	    }
+	    return std::string(strings + offset, length);
+	};
+	auto checkList = [&](const uint32_t* offsets, const uint32_t* indices, uint32_t num_indices, uint32_t bound) {
+	    for (uint32_t i = 0; i < header.num_tasks; i++) {
+		if (offsets[i] > offsets[i + 1]) throw std::invalid_argument("Corrupted workflow file " + filename);
+	    }
+	    if (offsets[0] != 0 or offsets[header.num_tasks] != num_indices) throw std::invalid_argument("Corrupted workflow file " + filename);
+	    for (uint32_t i = 0; i < num_indices; i++) {
+		if (indices[i] >= bound) throw std::invalid_argument("Corrupted workflow file " + filename);
+	    }
+	};
+	checkList(parent_offsets, parents, header.num_parents, header.num_tasks);
+	checkList(input_offsets, inputs, header.num_inputs, header.num_files);
+	checkList(output_offsets, outputs, header.num_outputs, header.num_files);
+
+	auto workflow = new Workflow();
+	workflow->setName(getString(header.name_offset, header.name_length));
+	workflow->setSubmittedTime(header.executed_at);
+
+	std::vector<WorkflowTask*> workflow_tasks(header.num_tasks);
+	for (uint32_t i = 0; i < header.num_tasks; i++) {
+	    const wfb::Task& t = tasks[i];
+	    WorkflowTask* task = workflow->addTask(getString(t.name_offset, t.name_length), t.runtime * flop_rate, t.cores, t.cores, t.memory);
+	    task->setAverageCPU(t.avg_cpu);
+	    task->setStaticHost(t.machine);
+	    task->setStaticStartTime(t.start_time);
+	    task->setStaticEndTime(t.end_time);
+	    workflow_tasks[i] = task;
+	}
+
+	std::vector<WorkflowFile*> workflow_files(header.num_files);
+	for (uint32_t i = 0; i < header.num_files; i++) {
+	    workflow_files[i] = workflow->addFile(getString(files[i].name_offset, files[i].name_length), files[i].size);
+	}
+
+	for (uint32_t i = 0; i < header.num_tasks; i++) {
+	    for (uint32_t k = input_offsets[i]; k < input_offsets[i + 1]; k++) {
+		workflow_tasks[i]->addInputFile(workflow_files[inputs[k]]);
+	    }
+	    for (uint32_t k = output_offsets[i]; k < output_offsets[i + 1]; k++) {
+		workflow_tasks[i]->addOutputFile(workflow_files[outputs[k]]);
+	    }
+	}
+
+	for (uint32_t i = 0; i < header.num_tasks; i++) {
+	    for (uint32_t k = parent_offsets[i]; k < parent_offsets[i + 1]; k++) {
+		workflow->addControlDependency(workflow_tasks[parents[k]], workflow_tasks[i]);
+	    }
+	}
+
+	return workflow;
+    }
+
+    /**
+     * @brief Read the submit time (executedAt) of a workflow from the header of its .wfb file
+     *
+     * @param filename: the path to the .wfb file
+     *
+     * @return the submit time
+     */
+    double BinaryWorkflowParser::getSubmittedTime(const std::string& filename) {
+	wfb::Header header;
+	std::ifstream file(filename, std::ios::binary);
+	if (not file.read(reinterpret_cast<char*>(&header), sizeof(header))
+	    or memcmp(header.magic, wfb::magic, sizeof(header.magic)) != 0) {
+	    throw std::invalid_argument("Not a binary workflow file: " + filename);
+	}
+	return header.executed_at;
+    }
+
+}
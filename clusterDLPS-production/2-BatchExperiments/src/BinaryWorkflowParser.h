@@ -0,0 +1,24 @@
+#ifndef WYY_SIMULATOR_BINARYWORKFLOWPARSER_H
+#define WYY_SIMULATOR_BINARYWORKFLOWPARSER_H
+
+#include <string>
+#include <wrench-dev.h>
+
+namespace wrench {
+
+    /**
+     * @brief A parser that builds a workflow from the packed binary format written by workflow2wfb
+     */
+    class BinaryWorkflowParser {
+
+    public:
+
+	static Workflow* createWorkflowFromWFB(const std::string& filename, const std::string& reference_flop_rate);
+
+	static double getSubmittedTime(const std::string& filename);
+
+    };
+
+}
+
+#endif // WYY_SIMULATOR_BINARYWORKFLOWPARSER_H
@@ -0,0 +1,195 @@
+#include <algorithm>
+
+#include "PilotJobPool.h"
+
+WRENCH_LOG_CATEGORY(pilot_job_pool, "Log category for PilotJobPool");
+
+namespace wrench {
+
+    /**
+     * @brief Constructor of an empty pool
+     *
+     * @param job_manager: the job manager of the dispatcher, which submits the pilot jobs and gets their events
+     * @param batch_services: the batch service of each pod, or the only batch service without pod locality
+     * @param pod_free_cores: the free cores of the pods shared by the schedulers, empty without pod locality
+     */
+    PilotJobPool::PilotJobPool(std::shared_ptr<JobManager> job_manager,
+			       const std::vector<std::shared_ptr<BatchComputeService>> &batch_services,
+			       std::shared_ptr<std::vector<double>> pod_free_cores) {
+	this->job_manager = job_manager;
+	this->batch_services = batch_services;
+	this->pod_free_cores = pod_free_cores;
+    }
+
+    /**
+     * @brief Take cores and memory for a unit in the first started pilot job of a pod that has them left
+     *
+     * @param pod: the pod of the unit, 0 without pod locality
+     * @param num_cores: the number of cores of the unit
+     * @param memory: the memory of the unit
+     *
+     * @return the pilot, or nullptr if none has room
+     */
+    std::shared_ptr<PilotJobPool::Pilot> PilotJobPool::place(int pod, double num_cores, double memory) {
+      for (auto &pilot : pilots) {
+	if (pilot->pod != pod or not pilot->compute_service) continue;
+	if (pilot->free_cores >= num_cores and pilot->free_memory >= memory) {
+	  pilot->free_cores -= num_cores;
+	  pilot->free_memory -= memory;
+	  pilot->num_jobs++;
+	  return pilot;
+	}
+      }
+      return nullptr;
+    }
+
+    /**
+     * @brief Give back the cores and memory of a standard job that has ended in a pilot job
+     *
+     * @param pilot: the pilot the job ran in
+     * @param num_cores: the cores taken by place()
+     * @param memory: the memory taken by place()
+     */
+    void PilotJobPool::release(const std::shared_ptr<Pilot> &pilot, double num_cores, double memory) {
+      pilot->free_cores += num_cores;
+      pilot->free_memory += memory;
+      if (--pilot->num_jobs == 0) {
+	pilot->idle_since = S4U_Simulation::getClock();
+      }
+    }
+
+    /**
+     * @brief Submit pilot jobs to a pod until it has as many waiting to start as asked for,
+     *        without holding more nodes than the pod has
+     *
+     * @param pod: the pod, 0 without pod locality
+     * @param num_pilots: the number of nodes the units that found no room would have filled
+     */
+    void PilotJobPool::requestPilots(int pod, unsigned long num_pilots) {
+      auto batch_service = batch_services[pod];
+
+      // The largest node of the pod, asked once
+      auto nodes = pod_nodes.find(pod);
+      if (nodes == pod_nodes.end()) {
+	double node_cores = 0;
+	double node_memory = 0;
+	auto per_host_cores = batch_service->getPerHostNumCores();
+	for (auto const &h : per_host_cores) node_cores = std::max(node_cores, (double) h.second);
+	for (auto const &h : batch_service->getMemoryCapacity()) node_memory = std::max(node_memory, h.second);
+	nodes = pod_nodes.emplace(pod, std::make_tuple(node_cores, node_memory, (unsigned long) per_host_cores.size())).first;
+      }
+      double node_cores = std::get<0>(nodes->second);
+      double node_memory = std::get<1>(nodes->second);
+      unsigned long num_nodes = std::get<2>(nodes->second);
+
+      unsigned long num_held = 0;
+      unsigned long num_waiting = 0;
+      for (auto &pilot : pilots) {
+	if (pilot->pod != pod) continue;
+	num_held++;
+	if (not pilot->compute_service) num_waiting++;
+      }
+
+      for (; num_waiting < num_pilots and num_held < num_nodes; num_waiting++, num_held++) {
+	auto job = job_manager->createPilotJob();
+	std::map<std::string, std::string> batch_job_args;
+	batch_job_args["-N"] = "1";
+	batch_job_args["-t"] = "2000000"; //time in minutes, terminated once idle
+	batch_job_args["-c"] = std::to_string((int) node_cores); //the whole node
+	try {
+	  job_manager->submitJob(job, batch_service, batch_job_args);
+	} catch (WorkflowExecutionException &e) {
+	  WRENCH_WARN("Cannot submit a pilot job: %s", e.getCause()->toString().c_str());
+	  return;
+	}
+	pilots.push_back(std::make_shared<Pilot>(Pilot{job, pod, nullptr, node_cores, node_memory, 0, S4U_Simulation::getClock()}));
+	if (pod < (int) pod_free_cores->size()) {
+	  (*pod_free_cores)[pod] -= node_cores;
+	}
+	WRENCH_DEBUG("Submitted a pilot job to pod %d", pod);
+      }
+    }
+
+    /**
+     * @brief Open a pilot job to standard jobs once its node is allocated
+     *
+     * @param job: a pilot job that has started
+     */
+    void PilotJobPool::pilotStarted(const std::shared_ptr<PilotJob> &job) {
+      for (auto &pilot : pilots) {
+	if (pilot->job == job) {
+	  pilot->compute_service = job->getComputeService();
+	  pilot->idle_since = S4U_Simulation::getClock();
+	  return;
+	}
+      }
+    }
+
+    /**
+     * @brief Drop a pilot job that has run out of time, failing the standard jobs still in it
+     *
+     * @param job: a pilot job that has expired
+     */
+    void PilotJobPool::pilotExpired(const std::shared_ptr<PilotJob> &job) {
+      for (auto it = pilots.begin(); it != pilots.end(); ++it) {
+	if ((*it)->job == job) {
+	  WRENCH_WARN("A pilot job expired with %lu standard jobs in it", (*it)->num_jobs);
+	  removePilot(it);
+	  return;
+	}
+      }
+    }
+
+    /**
+     * @brief Terminate the started pilot jobs that have run no standard job for a while,
+     *        giving their node back to the batch queue of their pod
+     *
+     * @param idle_timeout: how long a pilot job may stay idle
+     */
+    void PilotJobPool::terminateIdlePilots(double idle_timeout) {
+      double now = S4U_Simulation::getClock();
+      for (auto it = pilots.begin(); it != pilots.end(); ) {
+	auto &pilot = *it;
+	if (not pilot->compute_service or pilot->num_jobs > 0 or now - pilot->idle_since < idle_timeout) {
+	  ++it;
+	  continue;
+	}
+	try {
+	  job_manager->terminateJob(pilot->job);
+	} catch (WorkflowExecutionException &e) {
+	  WRENCH_DEBUG("Cannot terminate a pilot job: %s", e.getCause()->toString().c_str());
+	}
+	it = removePilot(it);
+      }
+    }
+
+    /**
+     * @brief Terminate every pilot job, started or not, once no workflow can use them
+     */
+    void PilotJobPool::terminateAllPilots() {
+      while (not pilots.empty()) {
+	try {
+	  job_manager->terminateJob(pilots.back()->job);
+	} catch (WorkflowExecutionException &e) {
+	  WRENCH_DEBUG("Cannot terminate a pilot job: %s", e.getCause()->toString().c_str());
+	}
+	removePilot(pilots.end() - 1);
+      }
+    }
+
+    /**
+     * @brief Forget a pilot job and give its node back to the free cores of its pod
+     *
+     * @param it: the pilot job
+     *
+     * @return the pilot job after it
+     */
+    std::vector<std::shared_ptr<PilotJobPool::Pilot>>::iterator PilotJobPool::removePilot(std::vector<std::shared_ptr<Pilot>>::iterator it) {
+      int pod = (*it)->pod;
+      if (pod < (int) pod_free_cores->size()) {
+	(*pod_free_cores)[pod] += std::get<0>(pod_nodes[pod]);
+      }
+      return pilots.erase(it);
+    }
+
+}
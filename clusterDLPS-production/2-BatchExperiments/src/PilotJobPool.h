@@ -0,0 +1,67 @@
+#ifndef WYY_SIMULATOR_PILOTJOBPOOL_H
+#define WYY_SIMULATOR_PILOTJOBPOOL_H
+
+#include <wrench-dev.h>
+#include <tuple>
+
+namespace wrench {
+
+    /**
+     *  @brief Whole nodes held as one-node pilot jobs by the dispatcher, into which the
+     *         schedulers of all workflows pack their units, so that a node runs the tasks
+     *         of several workflows
+     */
+    class PilotJobPool {
+
+    public:
+	/** @brief A pilot job and what is left of its node */
+	struct Pilot {
+	    std::shared_ptr<PilotJob> job;
+	    int pod;
+	    /** @brief The service standard jobs are submitted to, nullptr until the pilot job starts */
+	    std::shared_ptr<ComputeService> compute_service;
+	    double free_cores;
+	    double free_memory;
+	    unsigned long num_jobs;
+	    /** @brief When the last standard job in the pilot ended */
+	    double idle_since;
+	};
+
+	PilotJobPool(std::shared_ptr<JobManager> job_manager,
+		     const std::vector<std::shared_ptr<BatchComputeService>> &batch_services,
+		     std::shared_ptr<std::vector<double>> pod_free_cores);
+
+	std::shared_ptr<Pilot> place(int pod, double num_cores, double memory);
+
+	void release(const std::shared_ptr<Pilot> &pilot, double num_cores, double memory);
+
+	void requestPilots(int pod, unsigned long num_pilots);
+
+	void pilotStarted(const std::shared_ptr<PilotJob> &job);
+
+	void pilotExpired(const std::shared_ptr<PilotJob> &job);
+
+	void terminateIdlePilots(double idle_timeout);
+
+	void terminateAllPilots();
+
+    private:
+	std::vector<std::shared_ptr<Pilot>>::iterator removePilot(std::vector<std::shared_ptr<Pilot>>::iterator it);
+
+	/** @brief The job manager of the dispatcher, which gets the pilot job events */
+	std::shared_ptr<JobManager> job_manager;
+
+	/** @brief The batch service of each pod, or the only batch service without pod locality */
+	std::vector<std::shared_ptr<BatchComputeService>> batch_services;
+
+	/** @brief The free cores of the pods, taken off for as long as a pilot job holds a node */
+	std::shared_ptr<std::vector<double>> pod_free_cores;
+
+	/** @brief The cores, memory and number of nodes of each pod, asked on its first request */
+	std::map<int, std::tuple<double, double, unsigned long>> pod_nodes;
+
+	/** @brief The pilot jobs submitted and not ended yet, in submission order */
+	std::vector<std::shared_ptr<Pilot>> pilots;
+    };
+}
+#endif //WYY_SIMULATOR_PILOTJOBPOOL_H
@@ -4,20 +4,38 @@
 #include <wrench-dev.h>
 #include <set>
 #include <map>
+#include <unistd.h>
 #include <simgrid/plugins/dlps.h>
 #include <simgrid/plugins/dlps.hpp>
 #include <simgrid/s4u.hpp>
 #include <nlohmann/json.hpp>
 #include "Simulator.h"
 #include "wyyWMS.h"
+#include "WorkflowDispatcher.h"
 #include "BatchStandardJobScheduler.h"
 #include "helper/getAllFilesInDir.h"
+#include "BinaryWorkflowParser.h"
 #include "helper/endWith.h"
+#include "helper/readCorpusIndex.h"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(wyy_simulator, "Log category for the main simulator");
 
 using namespace wyy;
 
+/* Whether a cluster link without a dlps prop is tracked, by the names SimGrid gives the links
+ * between switches (or nodes) of each topology of generate-platform, not the ones to the nodes:
+ *     FAT_TREE:  link_from_<lower>_<upper>_<n>
+ *     DRAGONFLY: green_link_in_chassis_..., black_link_in_group_..., blue_link_between_group_...
+ *     TORUS:     <cluster>_link_from_<node>_to_<neighbor> */
+static bool isTrackedClusterLink(const std::string& link_name) {
+    auto startsWith = [&link_name](const std::string& prefix) { return link_name.compare(0, prefix.size(), prefix) == 0; };
+    if (startsWith("link_from_")) return true;
+    if (startsWith("green_link_") or startsWith("black_link_") or startsWith("blue_link_")) return true;
+    if (startsWith("local_link_")) return false; // DRAGONFLY router to node
+    size_t from = link_name.find("_link_from_");
+    return from != std::string::npos and link_name.find("_to_", from) != std::string::npos;
+}
+
 int Simulator::run(int argc, char** argv) {
 
     bool dlps_activated = false;
@@ -25,12 +43,43 @@ int Simulator::run(int argc, char** argv) {
 	dlps_activated = strcmp(argv[i], "--activate-dlps") ? dlps_activated : true;
     }
 
+    /* Replay the background trace only when asked to, and keep the switches away from WRENCH */
+    bool background_load = false;
+    bool pod_locality = false;
+    long pod_size = 0;
+    bool chain_jobs = false;
+    double pack_window = -1;
+    int num_args = 0;
+    for (int i = 0; i < argc; i++) {
+	if (strcmp(argv[i], "--background-load") == 0) {
+	    background_load = true;
+	} else if (strcmp(argv[i], "--pod-locality") == 0) {
+	    pod_locality = true;
+	} else if (strncmp(argv[i], "--pod-locality=", 15) == 0) {
+	    pod_locality = true;
+	    pod_size = std::atol(argv[i] + 15);
+	} else if (strcmp(argv[i], "--chain-jobs") == 0) {
+	    chain_jobs = true;
+	} else if (strcmp(argv[i], "--pack-jobs") == 0) {
+	    pack_window = 0;
+	} else if (strncmp(argv[i], "--pack-jobs=", 12) == 0) {
+	    pack_window = std::max(0.0, std::atof(argv[i] + 12));
+	} else {
+	    argv[num_args++] = argv[i];
+	}
+    }
+    argc = num_args;
+
     auto simulation = new wrench::Simulation();
     simulation->init(&argc, argv);
 
     if (argc != 7 and argc != 8) {
 	std::cerr << argc << std::endl;
-        std::cerr << "Usage: " << argv[0] << " <platform file> <background trace file> <workflow directory> <# of machines> <network factor> <scheduling algorithm> [host selection algorithm]" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <platform file> <background trace file> <workflow directory> <# of machines> <network factor> <scheduling algorithm> [host selection algorithm] [--background-load] [--pod-locality[=<nodes per pod>]] [--chain-jobs] [--pack-jobs[=<gather window (s)>]]" << std::endl;
+	std::cerr << "With --pack-jobs, the dispatcher holds whole nodes as pilot jobs and the ready tasks of all workflows are packed into them, tasks" << std::endl;
+	std::cerr << "that do not fit going out as packed batch jobs while more pilot jobs are asked for. A pilot job left idle for 60 s is terminated." << std::endl;
+	std::cerr << "A gather window holds the first ready tasks of a workflow back by up to its length to pack later ones with them; it is 0 by default." << std::endl;
+	std::cerr << "With --pod-locality, a background job whose SWF host id is h runs in the pod of node-(h % <# of compute nodes>)." << std::endl;
         exit(1);
     }
 
@@ -46,6 +95,18 @@ int Simulator::run(int argc, char** argv) {
     }
     std::cerr << "Instantiated a platform." << std::endl;
 
+    /* A directory of per-window SWF files only contributes the window of the workflows */
+    std::string background_trace_file = "";
+    if (background_load) {
+	try {
+	    background_trace_file = getBackgroundTraceFile(std::string(argv[2]), std::string(argv[3]));
+	} catch (std::invalid_argument &e) {
+	    std::cerr << "Cannot find the background load: " << e.what() << std::endl;
+	    exit(1);
+	}
+	std::cerr << "Background load from " << background_trace_file << "." << std::endl;
+    }
+
     /* Add a disk to each host */
     if (simgrid::s4u::Engine::is_initialized()) {
 	const simgrid::s4u::Engine* e = simgrid::s4u::Engine::get_instance();
@@ -58,19 +119,35 @@ int Simulator::run(int argc, char** argv) {
 		->set_property("mount", "/")
 		->seal();
 	}
+
+	/* Chained jobs keep their intermediate files on the scratch space of the batch services,
+	 * on the master, which gets a disk of its own for it */
+	if (chain_jobs) {
+	    e->host_by_name("master")->create_disk("scratch_disk", 1.0e18, 1.0e18)
+		->set_property("size", "1000EB")
+		->set_property("mount", "/scratch")
+		->seal();
+	}
     }
 
 
-    /* Select links for load tracking */
+    /* Select links for load tracking: the ones with a dlps prop of 1 (generate-platform --config),
+     * or by name the switch links of a cluster, whose links cannot carry props */
     if (simgrid::s4u::Engine::is_initialized() and dlps_activated) {
 	const simgrid::s4u::Engine* e = simgrid::s4u::Engine::get_instance();
+	long num_tracked = 0;
 	for (auto link : e->get_all_links()) {
-	    const char* link_name = link->get_cname();
-	    if (link_name[1] != 'i') continue;
-	    WRENCH_DEBUG("Enable tracking on link: %s", link->get_name().c_str());
+	    const char* dlps = link->get_property("dlps");
+	    if (dlps ? strcmp(dlps, "1") != 0 : not isTrackedClusterLink(link->get_name())) continue;
 	    WRENCH_DEBUG("Enable tracking on link: %s", link->get_name().c_str());
 	    sg_dlps_enable(link);
+	    num_tracked++;
 	}
+	if (num_tracked == 0) {
+	    std::cerr << "--activate-dlps found no link to track in " << platform_file << ": no dlps prop and no cluster link name it knows" << std::endl;
+	    exit(1);
+	}
+	std::cerr << "Tracking the load of " << num_tracked << " links." << std::endl;
 //	sg_dlps_enable(e->link_by_name("link_from_0_-1_0_UP"));
 //	sg_dlps_enable(e->link_by_name("link_from_0_-1_0_DOWN"));
     }
@@ -95,48 +172,87 @@ int Simulator::run(int argc, char** argv) {
 	WRENCH_DEBUG("Link: %s\tBW: %f", linkname.c_str(), wrench::Simulation::getLinkBandwidth(linkname));
     } */
 
+    /* One batch service for all nodes or, with pod locality, one per pod of the nodes under
+     * the same leaf switch, each replaying the background jobs of its own nodes */
+    std::vector<std::vector<std::string>> pods = {compute_nodes};
+    std::map<std::string, int> host_to_pod;
+    std::vector<std::string> background_trace_files = {background_trace_file};
+    if (pod_locality) {
+	try {
+	    pods = getPods(compute_nodes, pod_size);
+	    for (int p = 0; p < (int) pods.size(); p++) {
+		for (auto& node : pods[p]) host_to_pod[node] = p;
+	    }
+	    background_trace_files = background_trace_file.empty() ? std::vector<std::string>(pods.size(), "") :
+		splitBackgroundTrace(background_trace_file, host_to_pod, pods.size());
+	} catch (std::invalid_argument &e) {
+	    std::cerr << "Cannot split the cluster into pods: " << e.what() << std::endl;
+	    exit(1);
+	}
+	std::cerr << "Split " << compute_nodes.size() << " nodes into " << pods.size() << " pods." << std::endl;
+    }
+
+    /* The per-pod traces are only read while the services are constructed */
+    auto removePodTraceFiles = [&]() {
+	if (not pod_locality or background_trace_file.empty()) return;
+	for (auto& pod_trace_file : background_trace_files) {
+	    std::error_code ec;
+	    filesys::remove(pod_trace_file, ec);
+	}
+    };
+
     std::set<std::shared_ptr<wrench::ComputeService>> compute_services;
-    wrench::BatchComputeService* temp_batch_service = nullptr;
-    try {
-	temp_batch_service = new wrench::BatchComputeService(
-		master_node, compute_nodes, "", {
-		{wrench::BatchComputeServiceProperty::BATCH_SCHEDULING_ALGORITHM, std::string(argv[6])},
-		{wrench::BatchComputeServiceProperty::BATSCHED_CONTIGUOUS_ALLOCATION, "true"},
-		{wrench::BatchComputeServiceProperty::BATSCHED_LOGGING_MUTED, "true"},
-		{wrench::BatchComputeServiceProperty::HOST_SELECTION_ALGORITHM, argc == 7 ? "FIRSTFIT" : std::string(argv[7])},
-		{wrench::BatchComputeServiceProperty::IGNORE_INVALID_JOBS_IN_WORKLOAD_TRACE_FILE, "true"},
-		{wrench::BatchComputeServiceProperty::OUTPUT_CSV_JOB_LOG, "/tmp/batch_log.csv"},
-		{wrench::BatchComputeServiceProperty::SIMULATE_COMPUTATION_AS_SLEEP, "true"},
-		{wrench::BatchComputeServiceProperty::SIMULATED_WORKLOAD_TRACE_FILE, ""},
-		{wrench::BatchComputeServiceProperty::SUBMIT_TIME_OF_FIRST_JOB_IN_WORKLOAD_TRACE_FILE, "-1"},
-		{wrench::BatchComputeServiceProperty::TASK_SELECTION_ALGORITHM, "maximum_flops"},
-		{wrench::BatchComputeServiceProperty::TASK_STARTUP_OVERHEAD, "0"},
-		{wrench::BatchComputeServiceProperty::USE_REAL_RUNTIMES_AS_REQUESTED_RUNTIMES_IN_WORKLOAD_TRACE_FILE, "true"}
-		}, {
-		{wrench::BatchComputeServiceMessagePayload::STOP_DAEMON_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::RESOURCE_DESCRIPTION_REQUEST_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::RESOURCE_DESCRIPTION_ANSWER_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::DAEMON_STOPPED_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::STANDARD_JOB_DONE_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::SUBMIT_STANDARD_JOB_REQUEST_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::SUBMIT_STANDARD_JOB_ANSWER_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::TERMINATE_STANDARD_JOB_REQUEST_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::TERMINATE_STANDARD_JOB_ANSWER_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::SUBMIT_PILOT_JOB_REQUEST_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::SUBMIT_PILOT_JOB_ANSWER_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::STANDARD_JOB_FAILED_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::PILOT_JOB_STARTED_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::PILOT_JOB_EXPIRED_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::TERMINATE_PILOT_JOB_ANSWER_MESSAGE_PAYLOAD, 0},
-		{wrench::BatchComputeServiceMessagePayload::TERMINATE_PILOT_JOB_REQUEST_MESSAGE_PAYLOAD, 0}
-		}
-	);
-    } catch (std::invalid_argument &e) {
-	std::cerr << "Cannot instantiate a batch service: " << e.what() << std::endl;
-	exit(1);
+    std::vector<std::shared_ptr<wrench::BatchComputeService>> pod_services;
+    for (size_t p = 0; p < pods.size(); p++) {
+	wrench::BatchComputeService* temp_batch_service = nullptr;
+	try {
+	    temp_batch_service = new wrench::BatchComputeService(
+		    master_node, pods[p], chain_jobs ? "/scratch" : "", {
+		    {wrench::BatchComputeServiceProperty::BATCH_SCHEDULING_ALGORITHM, std::string(argv[6])},
+		    {wrench::BatchComputeServiceProperty::BATSCHED_CONTIGUOUS_ALLOCATION, "true"},
+		    {wrench::BatchComputeServiceProperty::BATSCHED_LOGGING_MUTED, "true"},
+		    {wrench::BatchComputeServiceProperty::HOST_SELECTION_ALGORITHM, argc == 7 ? "FIRSTFIT" : std::string(argv[7])},
+		    {wrench::BatchComputeServiceProperty::IGNORE_INVALID_JOBS_IN_WORKLOAD_TRACE_FILE, "true"},
+		    {wrench::BatchComputeServiceProperty::OUTPUT_CSV_JOB_LOG, pods.size() == 1 ? "/tmp/batch_log.csv" : "/tmp/batch_log_pod" + std::to_string(p) + ".csv"},
+		    {wrench::BatchComputeServiceProperty::SIMULATE_COMPUTATION_AS_SLEEP, "true"},
+		    {wrench::BatchComputeServiceProperty::SIMULATED_WORKLOAD_TRACE_FILE, background_trace_files[p]},
+		    {wrench::BatchComputeServiceProperty::SUBMIT_TIME_OF_FIRST_JOB_IN_WORKLOAD_TRACE_FILE, "-1"},
+		    {wrench::BatchComputeServiceProperty::TASK_SELECTION_ALGORITHM, "maximum_flops"},
+		    {wrench::BatchComputeServiceProperty::TASK_STARTUP_OVERHEAD, "0"},
+		    {wrench::BatchComputeServiceProperty::USE_REAL_RUNTIMES_AS_REQUESTED_RUNTIMES_IN_WORKLOAD_TRACE_FILE, "true"}
+		    }, {
+		    {wrench::BatchComputeServiceMessagePayload::STOP_DAEMON_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::RESOURCE_DESCRIPTION_REQUEST_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::RESOURCE_DESCRIPTION_ANSWER_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::DAEMON_STOPPED_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::STANDARD_JOB_DONE_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::SUBMIT_STANDARD_JOB_REQUEST_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::SUBMIT_STANDARD_JOB_ANSWER_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::TERMINATE_STANDARD_JOB_REQUEST_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::TERMINATE_STANDARD_JOB_ANSWER_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::SUBMIT_PILOT_JOB_REQUEST_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::SUBMIT_PILOT_JOB_ANSWER_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::STANDARD_JOB_FAILED_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::PILOT_JOB_STARTED_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::PILOT_JOB_EXPIRED_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::TERMINATE_PILOT_JOB_ANSWER_MESSAGE_PAYLOAD, 0},
+		    {wrench::BatchComputeServiceMessagePayload::TERMINATE_PILOT_JOB_REQUEST_MESSAGE_PAYLOAD, 0}
+		    }
+	    );
+	} catch (std::invalid_argument &e) {
+	    std::cerr << "Cannot instantiate a batch service: " << e.what() << std::endl;
+	    removePodTraceFiles();
+	    exit(1);
+	}
+	auto batch_service = simulation->add(temp_batch_service);
+	compute_services.insert(batch_service);
+	if (pod_locality) {
+	    pod_services.push_back(std::dynamic_pointer_cast<wrench::BatchComputeService>(batch_service));
+	}
+	std::cerr << "Instantiated a batch compute service on " << temp_batch_service->getHostname() <<" for " << pods[p].size() << " nodes with scheduling algorithm: " << temp_batch_service->getPropertyValueAsString(wrench::BatchComputeServiceProperty::BATCH_SCHEDULING_ALGORITHM) << "." << std::endl;
+
     }
-    compute_services.insert(simulation->add(temp_batch_service));
-    std::cerr << "Instantiated a batch compute service on " << temp_batch_service->getHostname() <<" with scheduling algorithm: " << temp_batch_service->getPropertyValueAsString(wrench::BatchComputeServiceProperty::BATCH_SCHEDULING_ALGORITHM) << "." << std::endl;
+    removePodTraceFiles();
 
     /* Debug */
     WRENCH_DEBUG("Current compute services in simulation:");
@@ -244,40 +360,60 @@ int Simulator::run(int argc, char** argv) {
     }
 
     /* Load all workflows from folder  *
-     * Each workflow instantiate a WMS */
+     * A single dispatcher starts a WMS for each workflow at its submit time */
     std::cerr << "Loading workflows..." << std::endl;
     std::vector<std::string> workflow_files = getAllFilesInDir(std::string(argv[3]));
 
-    std::set<shared_ptr<wrench::WMS>> wms_services;
+    wrench::WorkflowDispatcher* dispatcher = nullptr;
+    try {
+	dispatcher = new wrench::WorkflowDispatcher(
+		compute_services, storage_services, file_registry_service, master_node, hostname_to_storage_service, load_factor, network_factor,
+		host_to_pod, pod_services, chain_jobs, pack_window
+	);
+    } catch (std::invalid_argument &e) {
+	std::cerr << "Cannot instantiate the workflow dispatcher: " << e.what() << std::endl;
+	exit(1);
+    }
+
+    /* Submit times come from the corpus index next to the workflow files when there is
+     * one, so that the workflow files are only parsed by their WMS */
+    std::map<std::string, std::unordered_map<std::string, CorpusEntry>> corpus_indices;
+    long num_indexed = 0;
 
     std::mt19937 rng;
     std::uniform_real_distribution<double> dist(0.0, 1.0);
     rng.seed(std::atoi(argv[4]));
     for (auto workflow_file: workflow_files) {
 
+	if (endWith(workflow_file, "corpus.idx")) continue;
 	if (dist(rng) > load_factor) continue;
 
-	wrench::WMS* temp_wms = nullptr;
-	try {
-	    temp_wms = new wrench::wyyWMS(
-		    std::unique_ptr<wrench::BatchStandardJobScheduler> (new wrench::BatchStandardJobScheduler(hostname_to_storage_service)),
-		    nullptr, compute_services, storage_services, file_registry_service, master_node, hostname_to_storage_service, workflow_file, load_factor, network_factor
-	    );
-	} catch (std::invalid_argument &e) {
-	    std::cerr << "Cannot instantiate a WMS: " << e.what() << std::endl;
+	/* The binary loader does not apply the load factor the JSON parser gets, so refuse rather than diverge */
+	if (endWith(workflow_file, "wfb") and load_factor != 1.0) {
+	    std::cerr << "Cannot run .wfb workflows on " << argv[4] << " machines: the load factor is only applied to .json workflows, use those or 4096 machines" << std::endl;
 	    exit(1);
 	}
-	WRENCH_DEBUG("Instantiated a WMS for %s.", workflow_file.c_str());
-	temp_wms->setStartTime(getSubmittedTimeFromFile(workflow_file));
-	wms_services.insert(simulation->add(temp_wms));
-    }
-    std::cerr << "Instantiated a WMS for each workflow generated." << std::endl;
 
-    /* Debug */
-    WRENCH_DEBUG("Current WMS services in simulation:");
-    for (auto wms_serv : wms_services) {
-	WRENCH_DEBUG("On node: %s\tIs up: %s", wms_serv->getHostname().c_str(), wms_serv->isUp() ? "true" : "false");
+	filesys::path workflow_path(workflow_file);
+	auto itc = corpus_indices.find(workflow_path.parent_path().string());
+	if (itc == corpus_indices.end()) {
+	    itc = corpus_indices.emplace(workflow_path.parent_path().string(), readCorpusIndex(workflow_path.parent_path().string())).first;
+	}
+	auto ite = itc->second.find(workflow_path.filename().string());
+	double submitted_time = 0.0;
+	if (ite != itc->second.end()) {
+	    submitted_time = ite->second.submitted_time;
+	    num_indexed++;
+	} else {
+	    submitted_time = getSubmittedTimeFromFile(workflow_file);
+	}
+
+	dispatcher->addWorkflowFile(submitted_time, workflow_file);
+	WRENCH_DEBUG("Queued %s for %f.", workflow_file.c_str(), submitted_time);
     }
+    unsigned long num_workflows = dispatcher->getNumWorkflowFiles();
+    auto dispatcher_service = simulation->add(dispatcher);
+    std::cerr << "Queued " << num_workflows << " workflows for the dispatcher on " << dispatcher_service->getHostname() << " (" << num_indexed << " scheduled from a corpus index)." << std::endl;
 
     /* Launch the simulation */
     std::cerr << "Launching the simulation..." << std::endl;
@@ -417,14 +553,114 @@ double Simulator::getSubmittedTimeFromFile(std::string& workflow_file) {
 	    std::cerr << "No entry executedAt. WMS defer set to 0." << std::endl;
 	}
 	
+    } else if (endWith(workflow_file, "wfb")) {
+	submitted_time = wrench::BinaryWorkflowParser::getSubmittedTime(workflow_file);
     } else if (endWith(workflow_file, "dax")) {
     } else {
-	std::cerr << "Cannot read from " << workflow_file << ": not supporting formats other than .json and .dax" << std::endl;
+	std::cerr << "Cannot read from " << workflow_file << ": not supporting formats other than .json, .wfb and .dax" << std::endl;
     }
 
     return submitted_time;
 }
 
+/* The SWF window named like the workflow directory, e.g. output/swf/3-4.swf for
+ * workflows_without_file_size/3-4/, or the trace file itself when it is not a directory */
+std::string Simulator::getBackgroundTraceFile(const std::string& trace_path, const std::string& workflow_dir) {
+
+    if (not filesys::is_directory(trace_path)) return trace_path;
+
+    std::string window = workflow_dir;
+    while (endWith(window, "/")) window.pop_back();
+    window = window.substr(window.find_last_of('/') + 1);
+
+    std::string trace_file = (filesys::path(trace_path) / (window + ".swf")).string();
+    if (not filesys::exists(trace_file)) {
+	throw std::invalid_argument("no " + trace_file + " for workflows in " + workflow_dir);
+    }
+
+    return trace_file;
+}
+
+/* The number in a node name like node-12, -1 for other hosts */
+static long getNodeIndex(const std::string& node) {
+    size_t position = node.find_last_of('-');
+    if (position == std::string::npos or position + 1 == node.size()) return -1;
+    char* end = nullptr;
+    long index = std::strtol(node.c_str() + position + 1, &end, 10);
+    return *end == '\0' ? index : -1;
+}
+
+/* Pods of pod_size consecutive nodes by node number, pod_size coming from the pod_size prop
+ * of the platform (see generate-platform) when not given */
+std::vector<std::vector<std::string>> Simulator::getPods(const std::vector<std::string>& compute_nodes, long pod_size) {
+
+    if (pod_size <= 0 and not compute_nodes.empty()) {
+	auto host = simgrid::s4u::Engine::get_instance()->host_by_name(compute_nodes.front());
+	const char* prop = host->get_property("pod_size");
+	if (not prop and host->get_englobing_zone()) {
+	    prop = host->get_englobing_zone()->get_property("pod_size");
+	}
+	pod_size = prop ? std::atol(prop) : 0;
+    }
+    if (pod_size <= 0) {
+	throw std::invalid_argument("no pod_size prop in the platform, give --pod-locality=<nodes per pod>");
+    }
+
+    std::map<long, std::vector<std::string>> pods_by_index;
+    for (auto& node : compute_nodes) {
+	long index = getNodeIndex(node);
+	if (index < 0) {
+	    throw std::invalid_argument("cannot tell the pod of " + node);
+	}
+	pods_by_index[index / pod_size].push_back(node);
+    }
+
+    std::vector<std::vector<std::string>> pods;
+    for (auto& it : pods_by_index) {
+	pods.push_back(it.second);
+    }
+    return pods;
+}
+
+/* One SWF file per pod, in the temporary directory, with the jobs of the background trace
+ * whose host is in the pod. The host id h (the last field, see trace_to_swf) numbers the
+ * machines of the original cluster, so the job goes to node-(h % number of nodes) here.
+ * Comment lines go to every file. The caller removes the files once they are loaded. */
+std::vector<std::string> Simulator::splitBackgroundTrace(const std::string& trace_file, const std::map<std::string, int>& host_to_pod, int num_pods) {
+
+    std::ifstream trace(trace_file);
+    if (not trace) {
+	throw std::invalid_argument("cannot open " + trace_file);
+    }
+
+    std::vector<std::string> pod_trace_files;
+    std::vector<std::ofstream> pod_traces(num_pods);
+    for (int p = 0; p < num_pods; p++) {
+	pod_trace_files.push_back((filesys::temp_directory_path() /
+		    (filesys::path(trace_file).stem().string() + "_" + std::to_string(getpid()) + "_pod" + std::to_string(p) + ".swf")).string());
+	pod_traces[p].open(pod_trace_files.back());
+	if (not pod_traces[p]) {
+	    throw std::invalid_argument("cannot write " + pod_trace_files.back());
+	}
+    }
+
+    std::string line;
+    while (std::getline(trace, line)) {
+	size_t end = line.find_last_not_of(" \t\r");
+	if (end == std::string::npos) continue;
+	if (line[line.find_first_not_of(" \t")] == ';') {
+	    for (auto& pod_trace : pod_traces) pod_trace << line << "\n";
+	    continue;
+	}
+	size_t begin = line.find_last_of(" \t", end);
+	long host_id = std::atol(line.c_str() + (begin == std::string::npos ? 0 : begin + 1));
+	auto it = host_to_pod.find("node-" + std::to_string(host_to_pod.empty() ? 0 : host_id % (long) host_to_pod.size()));
+	pod_traces[it == host_to_pod.end() ? 0 : it->second] << line << "\n";
+    }
+
+    return pod_trace_files;
+}
+
 /* wrench::Workflow* Simulator::createWorkflowFromFile(std::string& workflow_file) {
 
     wrench::Workflow* workflow = nullptr;
@@ -11,6 +11,9 @@ namespace wyy {
 
         int run(int argc, char** argv);
 	double getSubmittedTimeFromFile(std::string&);
+	std::string getBackgroundTraceFile(const std::string&, const std::string&);
+	std::vector<std::vector<std::string>> getPods(const std::vector<std::string>&, long);
+	std::vector<std::string> splitBackgroundTrace(const std::string&, const std::map<std::string, int>&, int);
 	// wrench::Workflow* createWorkflowFromFile(std::string &);
     };
 
@@ -0,0 +1,53 @@
+#ifndef WYY_SIMULATOR_WORKFLOWBINARYFORMAT_H
+#define WYY_SIMULATOR_WORKFLOWBINARYFORMAT_H
+
+#include <cstdint>
+
+/* Packed binary copy of a workflow JSON (.wfb), written by workflow2wfb and
+ * loaded by BinaryWorkflowParser without building a JSON document.
+ *
+ * Layout, in native (little-endian) byte order: the header, the task array,
+ * the file table, then three CSR lists with the parents, input files and
+ * output files of each task (num_tasks + 1 offsets followed by the task or
+ * file indices), and last the string bytes the names point into. */
+namespace wfb {
+
+    const char magic[8] = {'W', 'F', 'B', '1', 0, 0, 0, 0};
+
+    struct Header {
+        char magic[8];
+        double executed_at;
+        uint32_t name_offset;
+        uint32_t name_length;
+        uint32_t num_tasks;
+        uint32_t num_files;
+        uint32_t num_parents;
+        uint32_t num_inputs;
+        uint32_t num_outputs;
+        uint32_t reserved;
+        uint64_t string_bytes;
+    };
+
+    struct Task {
+        uint32_t name_offset;
+        uint32_t name_length;
+        double runtime;
+        double avg_cpu;
+        double memory;
+        double start_time;  // startTimeInTrace
+        double end_time;    // endTimeInTrace
+        int64_t machine;
+        uint32_t cores;
+        uint32_t reserved;
+    };
+
+    struct File {
+        uint32_t name_offset;
+        uint32_t name_length;
+        double size;
+    };
+
+    static_assert(sizeof(Header) == 56 && sizeof(Task) == 64 && sizeof(File) == 16, "wfb records must stay packed");
+}
+
+#endif // WYY_SIMULATOR_WORKFLOWBINARYFORMAT_H
@@ -0,0 +1,195 @@
+#include <iostream>
+#include <algorithm>
+
+#include "WorkflowDispatcher.h"
+#include "BatchStandardJobScheduler.h"
+
+WRENCH_LOG_CATEGORY(workflow_dispatcher, "Log category for WorkflowDispatcher");
+
+/* Seconds a pilot job may run no task before its node goes back to the batch queue */
+static const double pilot_idle_timeout = 60;
+
+namespace wrench {
+
+    /**
+     * @brief Constructor of a dispatcher, with the services handed to each wyyWMS it starts
+     *
+     * @param compute_services: a set of compute services available to run jobs
+     * @param storage_services: a set of storage services available to the WMSes
+     * @param file_registry_service: the file registry service
+     * @param hostname: the name of the host on which to start the dispatcher and the WMSes
+     * @param hostname_to_storage_service: the storage service of each host
+     * @param load_factor: the load factor passed to each wyyWMS
+     * @param network_factor: the network factor passed to each wyyWMS
+     * @param host_to_pod: the pod of each compute node, empty without pod locality
+     * @param pod_services: the batch service of each pod, empty without pod locality
+     * @param chain_jobs: whether each wyyWMS submits task chains as single jobs
+     * @param pack_window: how long each wyyWMS gathers events before packing its ready tasks into the pilot jobs of the dispatcher, negative for no packing
+     */
+    WorkflowDispatcher::WorkflowDispatcher(const std::set<std::shared_ptr<ComputeService>> &compute_services,
+					   const std::set<std::shared_ptr<StorageService>> &storage_services,
+					   const std::shared_ptr<FileRegistryService> file_registry_service,
+					   const std::string &hostname,
+					   const std::map<std::string, std::shared_ptr<StorageService>> &hostname_to_storage_service,
+					   const double load_factor,
+					   const double network_factor,
+					   const std::map<std::string, int> &host_to_pod,
+					   const std::vector<std::shared_ptr<BatchComputeService>> &pod_services,
+					   bool chain_jobs,
+					   double pack_window) : WMS(
+            nullptr, nullptr,
+            compute_services,
+            storage_services,
+            {}, file_registry_service,
+            hostname,
+            "dispatcher") {
+	this->compute_services = compute_services;
+	this->storage_services = storage_services;
+	this->file_registry_service = file_registry_service;
+	this->hostname_to_storage_service = hostname_to_storage_service;
+	this->load_factor = load_factor;
+	this->network_factor = network_factor;
+	this->host_to_pod = host_to_pod;
+	this->pod_services = pod_services;
+	this->pod_free_cores = std::make_shared<BatchStandardJobScheduler::PodFreeCores>();
+	this->chain_jobs = chain_jobs;
+	this->pack_window = pack_window;
+    }
+
+    /**
+     * @brief Queue a workflow file, to be run by its own wyyWMS from its submit time on
+     *
+     * @param submitted_time: the submit time of the workflow
+     * @param workflow_file: the workflow file
+     */
+    void WorkflowDispatcher::addWorkflowFile(double submitted_time, const std::string &workflow_file) {
+	this->queue.emplace_back(submitted_time, workflow_file);
+    }
+
+    unsigned long WorkflowDispatcher::getNumWorkflowFiles() {
+	return this->queue.size();
+    }
+
+    /**
+     * @brief Drop the WMSes whose main() has returned, releasing them once their actor is gone
+     */
+    void WorkflowDispatcher::reclaimFinishedWMSes() {
+	this->running_wmses.erase(std::remove_if(this->running_wmses.begin(), this->running_wmses.end(),
+				  [](const std::shared_ptr<wyyWMS> &wms) { return wms->hasReturnedFromMain(); }),
+				  this->running_wmses.end());
+    }
+
+    /**
+     * @brief Wait until a date. With job packing, the pilot job events are processed meanwhile
+     *        and the pilot jobs left idle are terminated
+     *
+     * @param date: the date
+     */
+    void WorkflowDispatcher::waitUntil(double date) {
+	if (not this->pilot_pool) {
+	    double now = S4U_Simulation::getClock();
+	    if (date > now) {
+		S4U_Simulation::sleep(date - now);
+	    }
+	    return;
+	}
+	while (S4U_Simulation::getClock() < date) {
+	    try {
+		this->waitForAndProcessNextEvent(std::min(date - S4U_Simulation::getClock(), pilot_idle_timeout));
+	    } catch (WorkflowExecutionException &e) {
+		WRENCH_DEBUG("Error while getting next execution event (%s)... ignoring", e.getCause()->toString().c_str());
+	    }
+	    this->pilot_pool->terminateIdlePilots(pilot_idle_timeout);
+	}
+    }
+
+    /**
+     * @brief Process a WorkflowExecutionEvent::PILOT_JOB_START, opening the node to the WMSes
+     *
+     * @param event: a workflow execution event
+     */
+    void WorkflowDispatcher::processEventPilotJobStart(std::shared_ptr<PilotJobStartedEvent> event) {
+	this->pilot_pool->pilotStarted(event->pilot_job);
+    }
+
+    /**
+     * @brief Process a WorkflowExecutionEvent::PILOT_JOB_EXPIRATION
+     *
+     * @param event: a workflow execution event
+     */
+    void WorkflowDispatcher::processEventPilotJobExpiration(std::shared_ptr<PilotJobExpiredEvent> event) {
+	this->pilot_pool->pilotExpired(event->pilot_job);
+    }
+
+    /**
+     * @brief main method of the dispatcher daemon
+     *
+     * @return 0 on completion
+     */
+    int WorkflowDispatcher::main() {
+
+      TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_CYAN);
+
+      // Equal submit times keep the order in which the workflows were queued
+      std::stable_sort(this->queue.begin(), this->queue.end(),
+		       [](const std::pair<double, std::string> &a, const std::pair<double, std::string> &b) { return a.first < b.first; });
+
+      // With job packing, the dispatcher holds the pilot jobs of all WMSes. Their events go to the
+      // callback mailbox of a workflow, so it gets an empty one.
+      if (pack_window >= 0) {
+	this->addWorkflow(new Workflow(), S4U_Simulation::getClock());
+	std::vector<std::shared_ptr<BatchComputeService>> pool_services = pod_services;
+	if (pool_services.empty()) {
+	    pool_services.push_back(std::dynamic_pointer_cast<BatchComputeService>(*compute_services.begin()));
+	}
+	this->pilot_pool = std::make_shared<PilotJobPool>(this->createJobManager(), pool_services, pod_free_cores);
+      }
+
+      unsigned long max_running = 0;
+      for (auto &entry : this->queue) {
+	waitUntil(entry.first);
+	reclaimFinishedWMSes();
+
+	std::shared_ptr<wyyWMS> wms;
+	try {
+	    wms = std::shared_ptr<wyyWMS>(new wyyWMS(
+		    std::unique_ptr<BatchStandardJobScheduler> (new BatchStandardJobScheduler(hostname_to_storage_service, host_to_pod, pod_services, pod_free_cores, chain_jobs, pilot_pool)),
+		    nullptr, compute_services, storage_services, file_registry_service, this->getHostname(), hostname_to_storage_service, entry.second, load_factor, network_factor,
+		    std::max(0.0, pack_window)
+	    ));
+	} catch (std::invalid_argument &e) {
+	    throw std::runtime_error("Cannot instantiate a WMS for " + entry.second + ": " + e.what());
+	}
+
+	// Started like Simulation::launch() starts the WMSes added before it: not daemonized, no auto-restart
+	wms->simulation = this->simulation;
+	wms->start(wms, false, false);
+	WRENCH_DEBUG("Started a WMS for %s.", entry.second.c_str());
+
+	this->running_wmses.push_back(wms);
+	max_running = std::max<unsigned long>(max_running, this->running_wmses.size());
+      }
+      WRENCH_INFO("Dispatched %lu workflows, at most %lu WMSes at a time.", (unsigned long) this->queue.size(), max_running);
+
+      this->queue.clear();
+      this->queue.shrink_to_fit();
+
+      // The pilot jobs stay up for as long as a WMS may submit to them
+      if (this->pilot_pool) {
+	reclaimFinishedWMSes();
+	while (not this->running_wmses.empty()) {
+	    waitUntil(S4U_Simulation::getClock() + pilot_idle_timeout);
+	    reclaimFinishedWMSes();
+	}
+	this->pilot_pool->terminateAllPilots();
+	this->pilot_pool.reset();
+	this->getWorkflow()->deleteWorkflow();
+      }
+
+      // The WMSes still running hold a reference to themselves through their actor
+      this->running_wmses.clear();
+
+      return 0;
+    }
+
+}
@@ -0,0 +1,79 @@
+#ifndef WYY_SIMULATOR_WORKFLOWDISPATCHER_H
+#define WYY_SIMULATOR_WORKFLOWDISPATCHER_H
+
+#include <wrench-dev.h>
+#include "wyyWMS.h"
+#include "BatchStandardJobScheduler.h"
+#include "PilotJobPool.h"
+
+namespace wrench {
+
+    /**
+     *  @brief A WMS that starts a wyyWMS for each workflow at its submit time
+     */
+    class WorkflowDispatcher : public WMS {
+
+    public:
+	WorkflowDispatcher(const std::set<std::shared_ptr<ComputeService>> &compute_services,
+			   const std::set<std::shared_ptr<StorageService>> &storage_services,
+			   const std::shared_ptr<FileRegistryService> file_registry_service,
+			   const std::string &hostname,
+			   const std::map<std::string, std::shared_ptr<StorageService>> &hostname_to_storage_service,
+			   const double load_factor,
+			   const double network_factor,
+			   const std::map<std::string, int> &host_to_pod = {},
+			   const std::vector<std::shared_ptr<BatchComputeService>> &pod_services = {},
+			   bool chain_jobs = false,
+			   double pack_window = -1);
+
+	void addWorkflowFile(double submitted_time, const std::string &workflow_file);
+
+	unsigned long getNumWorkflowFiles();
+
+    protected:
+	void processEventPilotJobStart(std::shared_ptr<PilotJobStartedEvent>) override;
+
+	void processEventPilotJobExpiration(std::shared_ptr<PilotJobExpiredEvent>) override;
+
+    private:
+        int main() override;
+
+	void reclaimFinishedWMSes();
+
+	void waitUntil(double date);
+
+	std::set<std::shared_ptr<ComputeService>> compute_services;
+
+	std::set<std::shared_ptr<StorageService>> storage_services;
+
+	std::shared_ptr<FileRegistryService> file_registry_service;
+
+        std::map<std::string, std::shared_ptr<StorageService>> hostname_to_storage_service;
+
+	double load_factor;
+
+	double network_factor;
+
+	std::map<std::string, int> host_to_pod;
+
+	std::vector<std::shared_ptr<BatchComputeService>> pod_services;
+
+	/** @brief The free cores of the pods, shared by the schedulers of all WMSes */
+	std::shared_ptr<BatchStandardJobScheduler::PodFreeCores> pod_free_cores;
+
+	bool chain_jobs;
+
+	/** @brief The event gathering window of packing WMSes, negative without job packing */
+	double pack_window;
+
+	/** @brief The pilot jobs the WMSes pack their tasks into, nullptr without job packing */
+	std::shared_ptr<PilotJobPool> pilot_pool;
+
+	/** @brief Workflow files by submit time, sorted when the dispatcher starts */
+	std::vector<std::pair<double, std::string>> queue;
+
+	/** @brief The WMSes started so far that have not returned yet */
+	std::vector<std::shared_ptr<wyyWMS>> running_wmses;
+    };
+}
+#endif //WYY_SIMULATOR_WORKFLOWDISPATCHER_H
@@ -0,0 +1,40 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+/* One workflow of a corpus.idx written by the converters */
+struct CorpusEntry {
+    double submitted_time;
+    long num_tasks;
+    double total_runtime;
+    unsigned long num_bytes;
+};
+
+/*
+ * Read the corpus.idx of a directory of workflow files.
+ *
+ * Lines are "<file name>\t<executedAt>\t<tasks>\t<runtime>\t<bytes>", '#' starts a
+ * comment. A later line for the same file replaces an earlier one, and a line that
+ * does not parse (e.g. cut off by an interrupted conversion) is skipped.
+ *
+ * Returns:
+ *     entries by file name, empty if the directory has no index
+ */
+static std::unordered_map<std::string, CorpusEntry> readCorpusIndex(const std::string& dirPath)
+{
+    std::unordered_map<std::string, CorpusEntry> entries;
+    std::ifstream file(dirPath + "/corpus.idx");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() or line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string file_name;
+        CorpusEntry entry;
+        if (std::getline(fields, file_name, '\t') and
+                fields >> entry.submitted_time >> entry.num_tasks >> entry.total_runtime >> entry.num_bytes) {
+            entries[file_name] = entry;
+        }
+    }
+    return entries;
+}
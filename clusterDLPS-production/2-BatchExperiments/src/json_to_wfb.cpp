@@ -0,0 +1,202 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <charconv>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include "WorkflowBinaryFormat.h"
+#include "helper/getAllFilesInDir.h"
+#include "helper/endWith.h"
+
+/* Names of a workflow, stored once each in the string bytes of the file */
+class StringTable {
+
+    public:
+	void add(const std::string& name, uint32_t& offset, uint32_t& length) {
+	    offset = this->bytes.size();
+	    length = name.size();
+	    this->bytes += name;
+	}
+	const std::string& getBytes() const { return this->bytes; }
+
+    private:
+	std::string bytes;
+};
+
+/* CSR list: the entries of task i are indices[offsets[i] .. offsets[i + 1]) */
+struct CSRList {
+    std::vector<uint32_t> offsets = {0};
+    std::vector<uint32_t> indices;
+
+    void endTask() { this->offsets.push_back(this->indices.size()); }
+};
+
+template <typename T>
+static void writeArray(std::ofstream& out, const std::vector<T>& values) {
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+/* Convert one workflow JSON; returns the number of tasks, total runtime and submit time for the corpus index */
+static void convertWorkflow(const std::string& json_file, const std::string& wfb_file, long& num_tasks, double& total_runtime, double& executed_at, uint64_t& num_bytes) {
+
+    std::ifstream in(json_file);
+    if (not in) {
+	throw std::invalid_argument("Cannot open " + json_file);
+    }
+    nlohmann::json j;
+    in >> j;
+
+    nlohmann::json& workflow = j.at("workflow");
+    nlohmann::json& jobs = workflow.at("jobs");
+
+    StringTable strings;
+    wfb::Header header = {};
+    memcpy(header.magic, wfb::magic, sizeof(header.magic));
+    header.executed_at = workflow.value("executedAt", 0.0);
+    strings.add(j.value("name", std::string()), header.name_offset, header.name_length);
+
+    std::vector<wfb::Task> tasks;
+    std::vector<wfb::File> files;
+    std::unordered_map<std::string, uint32_t> task_ids;
+    std::unordered_map<std::string, uint32_t> file_ids;
+    CSRList parents, inputs, outputs;
+
+    for (auto& job : jobs) {
+	std::string name = job.at("name").get<std::string>();
+	task_ids[name] = tasks.size();
+
+	wfb::Task task = {};
+	strings.add(name, task.name_offset, task.name_length);
+	task.runtime = job.value("runtime", 0.0);
+	task.avg_cpu = job.value("avgCPU", 0.0);
+	task.memory = job.value("memory", 0.0);
+	task.start_time = job.value("startTimeInTrace", 0.0);
+	task.end_time = job.value("endTimeInTrace", 0.0);
+	task.cores = job.value("cores", 1);
+	std::string machine = job.value("machine", std::string("-1"));
+	task.machine = -1;
+	std::from_chars(machine.data(), machine.data() + machine.size(), task.machine);
+	tasks.push_back(task);
+
+	for (auto& f : job.value("files", nlohmann::json::array())) {
+	    std::string file_name = f.at("name").get<std::string>();
+	    auto itf = file_ids.find(file_name);
+	    if (itf == file_ids.end()) {
+		wfb::File file = {};
+		strings.add(file_name, file.name_offset, file.name_length);
+		file.size = f.value("size", 0.0);
+		itf = file_ids.emplace(file_name, files.size()).first;
+		files.push_back(file);
+	    }
+	    (f.value("link", std::string()) == "output" ? outputs : inputs).indices.push_back(itf->second);
+	}
+	inputs.endTask();
+	outputs.endTask();
+    }
+
+    /* Parents may be listed before they appear as a job, so resolve them in a second pass */
+    for (auto& job : jobs) {
+	for (auto& p : job.value("parents", nlohmann::json::array())) {
+	    auto itt = task_ids.find(p.get<std::string>());
+	    if (itt == task_ids.end()) {
+		throw std::invalid_argument("Unknown parent " + p.get<std::string>() + " in " + json_file);
+	    }
+	    parents.indices.push_back(itt->second);
+	}
+	parents.endTask();
+    }
+
+    header.num_tasks = tasks.size();
+    header.num_files = files.size();
+    header.num_parents = parents.indices.size();
+    header.num_inputs = inputs.indices.size();
+    header.num_outputs = outputs.indices.size();
+    header.string_bytes = strings.getBytes().size();
+
+    std::ofstream out(wfb_file, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeArray(out, tasks);
+    writeArray(out, files);
+    for (CSRList* list : {&parents, &inputs, &outputs}) {
+	writeArray(out, list->offsets);
+	writeArray(out, list->indices);
+    }
+    out.write(strings.getBytes().data(), strings.getBytes().size());
+    num_bytes = out.tellp();
+    out.close();
+    if (not out) {
+	throw std::invalid_argument("Cannot write " + wfb_file);
+    }
+
+    num_tasks = tasks.size();
+    total_runtime = 0;
+    for (auto& task : tasks) total_runtime += task.runtime;
+    executed_at = header.executed_at;
+}
+
+/* One-time conversion of workflow JSON files into the binary format, keeping the directory layout */
+int main(int argc, char **argv) {
+
+    if (argc != 3) {
+	std::cerr << "Usage: " << argv[0] << " <workflow JSON file or directory> <output directory>" << std::endl;
+	exit(1);
+    }
+
+    filesys::path input_path(argv[1]);
+    filesys::path output_path(argv[2]);
+    std::vector<std::string> json_files;
+    if (filesys::is_directory(input_path)) {
+	json_files = getAllFilesInDir(input_path.string());
+    } else {
+	json_files.push_back(input_path.string());
+	input_path = input_path.parent_path();
+    }
+
+    /* Lines of the corpus index of every output directory */
+    std::map<std::string, std::string> corpus_indices;
+
+    long num_converted = 0;
+    for (auto& json_file : json_files) {
+	if (not endWith(json_file, ".json")) continue;
+
+	std::string relative_path = json_file.substr(input_path.string().size());
+	while (not relative_path.empty() and relative_path[0] == '/') relative_path.erase(0, 1);
+	filesys::path wfb_path = output_path / relative_path;
+	wfb_path.replace_extension(".wfb");
+	filesys::create_directories(wfb_path.parent_path());
+
+	long num_tasks;
+	double total_runtime, executed_at;
+	uint64_t num_bytes;
+	convertWorkflow(json_file, wfb_path.string(), num_tasks, total_runtime, executed_at, num_bytes);
+
+	/* Counts go through the integer overload: as doubles, 100000 would come out as 1e+05 */
+	char line[128];
+	char* position = line;
+	*position++ = '\t';
+	position = std::to_chars(position, line + sizeof(line), executed_at).ptr;
+	*position++ = '\t';
+	position = std::to_chars(position, line + sizeof(line), num_tasks).ptr;
+	*position++ = '\t';
+	position = std::to_chars(position, line + sizeof(line), total_runtime).ptr;
+	*position++ = '\t';
+	position = std::to_chars(position, line + sizeof(line), num_bytes).ptr;
+	corpus_indices[wfb_path.parent_path().string()] += wfb_path.filename().string() + std::string(line, position) + "\n";
+
+	if (++num_converted % 1000 == 0) {
+	    std::cerr << "Converted " << num_converted << " workflows...\r";
+	}
+    }
+
+    for (auto& it : corpus_indices) {
+	std::ofstream index(it.first + "/corpus.idx");
+	index << "# name\texecutedAt\ttasks\truntime\tbytes\n" << it.second;
+    }
+
+    std::cerr << "Converted " << num_converted << " workflows." << std::endl;
+
+    return 0;
+}
@@ -10,6 +10,8 @@
 #include <iostream>
 
 #include "wyyWMS.h"
+#include "BatchStandardJobScheduler.h"
+#include "BinaryWorkflowParser.h"
 #include "helper/endWith.h"
 
 WRENCH_LOG_CATEGORY(wyy_wms, "Log category for wyyWMS");
@@ -25,6 +27,7 @@ namespace wrench {
      * @param compute_services: a set of compute services available to run jobs
      * @param storage_services: a set of storage services available to the WMS
      * @param hostname: the name of the host on which to start the WMS
+     * @param gather_window: the time over which events are gathered into one scheduling pass (0 for none)
      */
     wyyWMS::wyyWMS(std::unique_ptr<StandardJobScheduler> standard_job_scheduler,
                          std::unique_ptr<PilotJobScheduler> pilot_job_scheduler,
@@ -35,7 +38,8 @@ namespace wrench {
 			 const std::map<std::string, std::shared_ptr<StorageService>> &hostname_to_storage_service,
 			 const std::string &workflow_file,
 			 const double load_factor,
-			 const double network_factor) : WMS(
+			 const double network_factor,
+			 const double gather_window) : WMS(
             std::move(standard_job_scheduler),
             std::move(pilot_job_scheduler),
             compute_services,
@@ -47,6 +51,7 @@ namespace wrench {
 	this->workflow_file = workflow_file;
 	this->load_factor = load_factor;
 	this->network_factor = network_factor;
+	this->gather_window = gather_window;
 	}
 
     /**
@@ -87,7 +92,7 @@ namespace wrench {
       this->job_manager = this->createJobManager();
 
       // Create a data movement manager
-      std::shared_ptr<DataMovementManager> data_movement_manager = this->createDataMovementManager();
+      this->data_movement_manager = this->createDataMovementManager();
 
       // Start bandwidth meters
       // std::shared_ptr<BandwidthMeterService> bw_meter_service = createBandwidthMeter(this->simulation->getLinknameList(), 0.01);
@@ -95,10 +100,12 @@ namespace wrench {
       // Perform static optimizations
       runStaticOptimizations();
 
-      while (true) {
+      // Only the entry tasks are ready now, later ones are queued as their parents complete
+      for (auto task : this->getWorkflow()->getReadyTasks()) {
+        queueReadyTask(task);
+      }
 
-        // Get the ready tasks
-        std::vector<WorkflowTask *> ready_tasks = this->getWorkflow()->getReadyTasks();
+      while (true) {
 
         // Get the available compute services
         auto compute_services = this->getAvailableComputeServices<ComputeService>();
@@ -117,32 +124,32 @@ namespace wrench {
         // Perform dynamic optimizations
         runDynamicOptimizations();
 
-        // Run ready tasks with defined scheduler implementation
-        WRENCH_DEBUG("Scheduling tasks...");
-	for (auto task: ready_tasks) {
-	    for (auto f : task->getInputFiles()) {
-                std::string local_host = "";
-                if (f->isOutput()){
-                    local_host = f->getOutputOf()->getExecutionHost();
-	    	    if (not local_host.empty()){
-		        if (not hostname_to_storage_service[local_host]->lookupFile(f, FileLocation::LOCATION(hostname_to_storage_service[local_host]))) {
-            	        data_movement_manager->doSynchronousFileCopy(f,
-		            FileLocation::LOCATION(hostname_to_storage_service["master"]),
-		            FileLocation::LOCATION(hostname_to_storage_service[local_host]));
-		        }
-	    	    } else {
-            	        data_movement_manager->doSynchronousFileCopy(f,
-		            FileLocation::LOCATION(hostname_to_storage_service["master"]),
-		            FileLocation::LOCATION(hostname_to_storage_service[this->getHostname()]));
-		    }
-		}
-	    }
+        // Copy the input files of the ready tasks all at once
+        for (auto task : ready_tasks) {
+	  stageInputFiles(task);
+        }
+        ready_tasks.clear();
+
+        // Run staged tasks with defined scheduler implementation
+        if (not staged_tasks.empty()) {
+	  WRENCH_DEBUG("Scheduling tasks...");
+          this->getStandardJobScheduler()->scheduleTasks(this->getAvailableComputeServices<ComputeService>(), staged_tasks);
+	  staged_tasks.clear();
 	}
-        this->getStandardJobScheduler()->scheduleTasks(this->getAvailableComputeServices<ComputeService>(), ready_tasks);
 
         // Wait for a workflow execution event, and process it
         try {
           this->waitForAndProcessNextEvent();
+
+          // Keep gathering within the window only while each event queues more tasks; the tasks
+          // queued first wait for the later ones, up to the whole window
+          double gather_end = S4U_Simulation::getClock() + gather_window;
+          size_t num_queued = ready_tasks.size() + staged_tasks.size();
+          while (num_queued > 0 and not this->abort and not this->getWorkflow()->isDone() and S4U_Simulation::getClock() < gather_end and
+                 this->waitForAndProcessNextEvent(gather_end - S4U_Simulation::getClock())) {
+            if (ready_tasks.size() + staged_tasks.size() == num_queued) break;
+            num_queued = ready_tasks.size() + staged_tasks.size();
+          }
         } catch (WorkflowExecutionException &e) {
           WRENCH_DEBUG("Error while getting next execution event (%s)... ignoring and trying again",
                       (e.getCause()->toString().c_str()));
@@ -189,10 +196,121 @@ namespace wrench {
       }
       this->getWorkflow()->deleteWorkflow();
       this->job_manager.reset();
+      this->data_movement_manager.reset();
 
       return 0;
     }
 
+    /**
+     * @brief Queue a ready task for the next scheduling pass, unless it was queued before
+     *
+     * @param task: a ready task
+     */
+    void wyyWMS::queueReadyTask(WorkflowTask* task) {
+      if (queued_tasks.insert(task).second) {
+	ready_tasks.push_back(task);
+      }
+    }
+
+    /**
+     * @brief Start copying the parent outputs a task reads to the hosts they are read from,
+     *        or stage the task right away if none has to be copied
+     *
+     * @param task: a ready task
+     */
+    void wyyWMS::stageInputFiles(WorkflowTask* task) {
+      int num_copies = 0;
+      for (auto f : task->getInputFiles()) {
+	if (not f->isOutput()) continue;
+
+	std::string local_host = f->getOutputOf()->getExecutionHost();
+	if (local_host.empty()) {
+	  local_host = this->getHostname();
+	}
+	auto key = std::make_pair(f, local_host);
+
+	// Copies only come from this WMS, so its own record replaces a lookup on the storage service
+	if (resident_files[f].insert(local_host).second) {
+	  data_movement_manager->initiateAsynchronousFileCopy(f,
+	      FileLocation::LOCATION(hostname_to_storage_service["master"]),
+	      FileLocation::LOCATION(hostname_to_storage_service[local_host]));
+	  copy_waiters[key].push_back(task);
+	  num_copies++;
+	} else if (copy_waiters.find(key) != copy_waiters.end()) {
+	  copy_waiters[key].push_back(task);
+	  num_copies++;
+	}
+      }
+
+      if (num_copies == 0) {
+	staged_tasks.push_back(task);
+      } else {
+	pending_copies[task] = num_copies;
+      }
+    }
+
+    /**
+     * @brief Tell the batch scheduler that the cores of a job are free again
+     *
+     * @param job: a standard job that has ended
+     */
+    void wyyWMS::releaseCores(std::shared_ptr<StandardJob> job) {
+      auto scheduler = dynamic_cast<BatchStandardJobScheduler *>(this->getStandardJobScheduler());
+      if (scheduler) {
+	scheduler->releaseCores(job);
+      }
+    }
+
+    /**
+     * @brief Process a WorkflowExecutionEvent::FILE_COPY_COMPLETION, staging the tasks
+     *        that waited for no other copy
+     *
+     * @param event: a workflow execution event
+     */
+    void wyyWMS::processEventFileCopyCompletion(std::shared_ptr<FileCopyCompletedEvent> event) {
+      auto it = copy_waiters.find(std::make_pair(event->file, event->dst->getStorageService()->getHostname()));
+      if (it == copy_waiters.end()) return;
+
+      for (auto task : it->second) {
+	if (--pending_copies[task] == 0) {
+	  pending_copies.erase(task);
+	  staged_tasks.push_back(task);
+	}
+      }
+      copy_waiters.erase(it);
+    }
+
+    /**
+     * @brief Process a WorkflowExecutionEvent::FILE_COPY_FAILURE
+     *
+     * @param event: a workflow execution event
+     */
+    void wyyWMS::processEventFileCopyFailure(std::shared_ptr<FileCopyFailedEvent> event) {
+      WRENCH_DEBUG("Notified that the copy of %s has failed", event->file->getID().c_str());
+      WRENCH_DEBUG("CauseType: %s", event->failure_cause->toString().c_str());
+      WRENCH_DEBUG("As wyyWMS, I abort as soon as there is a failure");
+      this->abort = true;
+    }
+
+    /**
+     * @brief Process a WorkflowExecutionEvent::STANDARD_JOB_COMPLETION, queueing the
+     *        children of its tasks that it made ready
+     *
+     * @param event: a workflow execution event
+     */
+    void wyyWMS::processEventStandardJobCompletion(std::shared_ptr<StandardJobCompletedEvent> event) {
+      auto job = event->standard_job;
+      WRENCH_DEBUG("Notified that a standard job has successfully completed");
+      releaseCores(job);
+      for (auto task : job->getTasks()) {
+	for (auto child : task->getChildren()) {
+	  if (child->getState() == WorkflowTask::State::READY) {
+	    queueReadyTask(child);
+	  }
+	}
+      }
+    }
+
     /**
      * @brief Process a WorkflowExecutionEvent::STANDARD_JOB_FAILURE
      *
@@ -201,6 +319,7 @@ namespace wrench {
     void wyyWMS::processEventStandardJobFailure(std::shared_ptr<StandardJobFailedEvent> event) {
       auto job = event->standard_job;
       WRENCH_DEBUG("Notified that a standard job has failed (all its tasks are back in the ready state)");
+      releaseCores(job);
       WRENCH_DEBUG("CauseType: %s", event->failure_cause->toString().c_str());
       WRENCH_DEBUG("As wyyWMS, I abort as soon as there is a failure");
       this->abort = true;
@@ -216,6 +335,12 @@ namespace wrench {
 	} catch (std::invalid_argument &e) {
 	  std::cerr << "Cannot create a workflow from " << workflow_file << ": " << e.what() << std::endl;
 	}
+      } else if (endWith(workflow_file, "wfb")) {
+	try {
+	    workflow = BinaryWorkflowParser::createWorkflowFromWFB(workflow_file, "1f");
+	} catch (std::invalid_argument &e) {
+	  std::cerr << "Cannot create a workflow from " << workflow_file << ": " << e.what() << std::endl;
+	}
       } else if (endWith(workflow_file, "dax")) {
 	try {
 	  workflow = PegasusWorkflowParser::createWorkflowFromDAX(workflow_file, "1f");
@@ -224,7 +349,7 @@ namespace wrench {
 	}
 
       } else {
-	std::cerr << "Cannot create a workflow from " << workflow_file << ": not supporting formats other than .json and .dax" << std::endl;
+	std::cerr << "Cannot create a workflow from " << workflow_file << ": not supporting formats other than .json, .wfb and .dax" << std::endl;
       }
 
       // update workflow by network factor
@@ -21,6 +21,9 @@ namespace wrench {
      */
     class wyyWMS : public WMS {
 
+	/** @brief Starts the WMS during the simulation instead of Simulation::add() */
+	friend class WorkflowDispatcher;
+
     public:
         wyyWMS(std::unique_ptr<StandardJobScheduler> standard_job_scheduler,
                   std::unique_ptr<PilotJobScheduler> pilot_job_scheduler,
@@ -31,20 +34,30 @@ namespace wrench {
 		  const std::map<std::string, std::shared_ptr<StorageService>> &hostname_to_storage_service,
 		  const std::string &workflow_file,
 		  const double load_factor,
-		  const double network_factor);
+		  const double network_factor,
+		  const double gather_window = 0);
 
 	Workflow* createWorkflowFromFile(std::string&);
 
     protected:
 
+        void processEventStandardJobCompletion(std::shared_ptr<StandardJobCompletedEvent>) override;
+
         void processEventStandardJobFailure(std::shared_ptr<StandardJobFailedEvent>) override;
 
+        void processEventFileCopyCompletion(std::shared_ptr<FileCopyCompletedEvent>) override;
+
+        void processEventFileCopyFailure(std::shared_ptr<FileCopyFailedEvent>) override;
+
     private:
         int main() override;
 
         /** @brief The job manager */
         std::shared_ptr<JobManager> job_manager;
 
+        /** @brief The data movement manager */
+        std::shared_ptr<DataMovementManager> data_movement_manager;
+
         std::map<std::string, std::shared_ptr<StorageService>> hostname_to_storage_service;
 
 	std::string workflow_file;
@@ -52,7 +65,34 @@ namespace wrench {
 	double load_factor;
 	
 	double network_factor;
+
+	/** @brief How long to keep taking events after one, so that their ready tasks are scheduled together */
+	double gather_window;
         
+	void queueReadyTask(WorkflowTask*);
+
+	/** @brief Ready tasks not submitted yet, filled from job completions */
+	std::vector<WorkflowTask*> ready_tasks;
+
+	/** @brief Every task ever queued, so that no task is submitted twice */
+	std::set<WorkflowTask*> queued_tasks;
+
+	void stageInputFiles(WorkflowTask*);
+
+	void releaseCores(std::shared_ptr<StandardJob>);
+
+	/** @brief Hosts whose storage service got, or is getting, a copy of each file from this WMS */
+	std::map<WorkflowFile*, std::set<std::string>> resident_files;
+
+	/** @brief Tasks waiting for each copy in progress, by file and destination host */
+	std::map<std::pair<WorkflowFile*, std::string>, std::vector<WorkflowTask*>> copy_waiters;
+
+	/** @brief Number of copies in progress each staging task waits for */
+	std::map<WorkflowTask*, int> pending_copies;
+
+	/** @brief Tasks with all their input files in place, to be submitted */
+	std::vector<WorkflowTask*> staged_tasks;
+
 	/** @brief Whether the workflow execution should be aborted */
         bool abort = false;
     };
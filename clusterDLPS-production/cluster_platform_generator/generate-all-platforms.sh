@@ -1,6 +1,7 @@
 #!/bin/bash
 
-for nMachines in 4 8 16 32 64 128 256 512 1024 2048 4096
-do
-	./generate-platform fat_tree ${nMachines}
-done	
+# The whole sweep in one run, one platform per thread at a time
+./generate-platform fat_tree,dragonfly,torus 4,8,16,32,64,128,256,512,1024,2048,4096,8192,16384,32768 --threads=$(nproc)
+
+# Leaf-spine platforms described by a config, with DLPS tracking on the spine tier
+./generate-platform $(for config in configs/*.json; do echo --config=${config}; done)
@@ -2,66 +2,71 @@
 #include <fstream>
 #include <locale>
 #include <set>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <algorithm>
+#include <sstream>
 #include <math.h>
 #include <pugixml.hpp>
+#include <nlohmann/json.hpp>
 
-int main(int argc, char **argv) {
-
-    if (argc != 3) {
-	std::cerr << "Usage: " << argv[0] << " <topology> <number of machines>" << std::endl;
-        exit(1);
-    }
-
-    int num_machine = 4;
-    try {
-        num_machine = std::atoi(argv[2]);
-    } catch (std::invalid_argument &e) {
-        std::cerr << "Invalid number of machines. Must be 2^{2:12}." << std::endl;
-        exit(1);
-    }
+static std::mutex output_mutex;
 
-    if (log2(num_machine) < 2 || log2(num_machine) > 12 || log2(num_machine) != (int) log2(num_machine)) {
-        std::cerr << "Invalid number of machines. Must be 2^{2:12}." << std::endl;
-        exit(1);
-    }
-
-    std::string topology = argv[1];
-    std::string topo_name = "";
-    std::locale loc;
-    for (std::string::size_type i = 0; i < topology.length(); ++i) {
-	topo_name.push_back(std::toupper(topology[i], loc));
+/* Largest divisor of n not above limit */
+static long largestDivisorBelow(long n, double limit) {
+    for (long d = std::max(1L, std::min(n, (long) floor(limit + 1e-9))); d > 1; d--) {
+	if (n % d == 0) return d;
     }
+    return 1;
+}
 
-    std::set<std::string> supported_topology = {"FAT_TREE"};
-    if (supported_topology.find(topo_name) == supported_topology.end()) {
-	std::cerr << "Invalid topology name. Currently support ";
-        for (auto it = supported_topology.begin(); it != supported_topology.end(); ++it) {
-	    std::cerr << "[" << *it << "] ";
-	}
-	std::cerr << std::endl;
-	exit(1);
+/* Split n into the given number of factors, each as close to the matching root of n as
+ * the divisors of n allow, the largest first (a prime n gives n,1,...,1) */
+static std::vector<long> splitIntoFactors(long n, int num_factors) {
+    std::vector<long> factors;
+    for (int i = num_factors; i > 1; i--) {
+	long f = largestDivisorBelow(n, pow((double) n, 1.0 / i));
+	factors.push_back(f);
+	n /= f;
     }
+    factors.push_back(n);
+    std::sort(factors.rbegin(), factors.rend());
+    return factors;
+}
 
-    /* Prepare some parameters */
-    std::string radical = "0-" + std::to_string(num_machine - 1);
-    std::string topo_parameter;
+/*
+ * SimGrid topo_parameters of a cluster of num_machine nodes, and the number of
+ * consecutive nodes that share the first switch level (pod_size):
+ *     FAT_TREE:  2 levels, leaf switches of m1 nodes under w2 core switches with
+ *                p2 parallel links each, w2 * p2 = m1 (the former 2^{2:12} values)
+ *     DRAGONFLY: groups,1;chassis,1;routers,1;nodes per router
+ *     TORUS:     X,Y,Z with X*Y*Z = num_machine
+ */
+static std::string getTopologyParameters(const std::string& topo_name, long num_machine, long& pod_size) {
     if (topo_name == "FAT_TREE") {
-	double sr = sqrt(num_machine);
-	int p, m;
-	if (sr - floor(sr) == 0) {
-	    p = 2 * (int) sr;
-	    m = (int) sr; 
-	} else {
-	    p = 4 * (int) sqrt(num_machine / 2);
-	    m = (int) sqrt(num_machine / 2);
-	}
-	topo_parameter = "2;" + std::to_string(p / 2) + "," + std::to_string(m) + ";1," + std::to_string(m / 2) + ";1," + std::to_string(p / m);
+	long m2 = largestDivisorBelow(num_machine, sqrt(num_machine));
+	long m1 = num_machine / m2;
+	long w2 = largestDivisorBelow(m1, std::max(1L, m2 / 2));
+	long p2 = m1 / w2;
+	pod_size = m1;
+	return "2;" + std::to_string(m1) + "," + std::to_string(m2) + ";1," + std::to_string(w2) + ";1," + std::to_string(p2);
+    } else if (topo_name == "DRAGONFLY") {
+	std::vector<long> f = splitIntoFactors(num_machine, 4);
+	pod_size = f[1] * f[2] * f[3];
+	return std::to_string(f[0]) + ",1;" + std::to_string(f[1]) + ",1;" + std::to_string(f[2]) + ",1;" + std::to_string(f[3]);
+    } else {
+	std::vector<long> f = splitIntoFactors(num_machine, 3);
+	pod_size = f[0];
+	return std::to_string(f[0]) + "," + std::to_string(f[1]) + "," + std::to_string(f[2]);
     }
+}
 
-    std::string outfile_path = "platforms/cluster_" + std::to_string(num_machine) + "_machines_" + topo_name + ".xml";
-    std::cerr << "Generating: " << outfile_path << std::endl;
-
-    pugi::xml_document doc;
+/* An empty platform with the zone holding the cluster and the master host */
+static pugi::xml_node newPlatform(pugi::xml_document& doc) {
 
     auto declaration = doc.prepend_child(pugi::node_declaration);
     declaration.append_attribute("version") = "1.0";
@@ -74,23 +79,11 @@ int main(int argc, char **argv) {
     big_zone.append_attribute("id")      = "Cluster_and_a_host";
     big_zone.append_attribute("routing") = "Full";
 
-    auto cluster_zone = big_zone.append_child("cluster");
-    cluster_zone.append_attribute("id")              = "Computation";
-    cluster_zone.append_attribute("prefix")          = "node-";
-    cluster_zone.append_attribute("radical")         = radical.c_str();
-    cluster_zone.append_attribute("suffix")          = "";
-    cluster_zone.append_attribute("speed")           = "1f";
-    cluster_zone.append_attribute("core")            = "96";
-    cluster_zone.append_attribute("bw")              = "300Gbps";
-    cluster_zone.append_attribute("lat")             = "0us"; //"20us";
-    cluster_zone.append_attribute("topology")        = topo_name.c_str();
-    cluster_zone.append_attribute("topo_parameters") = topo_parameter.c_str();
-    cluster_zone.append_attribute("loopback_bw")     = "1000EBps";
-    cluster_zone.append_attribute("loopback_lat")    = "0us";
-    cluster_zone.append_attribute("router_id")       = "cluster_router";
-    cluster_zone.append_attribute("sharing_policy")  = "SPLITDUPLEX";
+    return big_zone;
+}
 
-    // auto host = cluster.append_child("host");
+/* The master host with its cloud disk, routed to the cluster through its cluster_router */
+static void appendMasterZone(pugi::xml_node& big_zone) {
 
     auto host_zone = big_zone.append_child("zone");
     host_zone.append_attribute("id")      = "Master";
@@ -136,7 +129,9 @@ int main(int argc, char **argv) {
     zone_route.append_attribute("gw_src") = "cluster_router";
     zone_route.append_attribute("gw_dst") = "master";
     zone_route.append_child("link_ctn").append_attribute("id").set_value("fast_link");
+}
 
+static void savePlatform(pugi::xml_document& doc, const std::string& outfile_path) {
     std::ofstream file;
     file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
     try {
@@ -146,6 +141,369 @@ int main(int argc, char **argv) {
     } catch (const std::ofstream::failure &e) {
         throw std::invalid_argument("Cannot open file for output!");
     }
+}
+
+static void generatePlatform(const std::string& topo_name, long num_machine) {
+
+    /* Prepare some parameters */
+    std::string radical = "0-" + std::to_string(num_machine - 1);
+    long pod_size = num_machine;
+    std::string topo_parameter = getTopologyParameters(topo_name, num_machine, pod_size);
+
+    std::string outfile_path = "platforms/cluster_" + std::to_string(num_machine) + "_machines_" + topo_name + ".xml";
+    {
+	std::lock_guard<std::mutex> lock(output_mutex);
+	std::cerr << "Generating: " << outfile_path << " (" << topo_parameter << ")" << std::endl;
+    }
+
+    pugi::xml_document doc;
+    auto big_zone = newPlatform(doc);
+
+    auto cluster_zone = big_zone.append_child("cluster");
+    cluster_zone.append_attribute("id")              = "Computation";
+    cluster_zone.append_attribute("prefix")          = "node-";
+    cluster_zone.append_attribute("radical")         = radical.c_str();
+    cluster_zone.append_attribute("suffix")          = "";
+    cluster_zone.append_attribute("speed")           = "1f";
+    cluster_zone.append_attribute("core")            = "96";
+    cluster_zone.append_attribute("bw")              = "300Gbps";
+    cluster_zone.append_attribute("lat")             = "0us"; //"20us";
+    cluster_zone.append_attribute("topology")        = topo_name.c_str();
+    cluster_zone.append_attribute("topo_parameters") = topo_parameter.c_str();
+    cluster_zone.append_attribute("loopback_bw")     = "1000EBps";
+    cluster_zone.append_attribute("loopback_lat")    = "0us";
+    cluster_zone.append_attribute("router_id")       = "cluster_router";
+    cluster_zone.append_attribute("sharing_policy")  = "SPLITDUPLEX";
+
+    auto pod_prop = cluster_zone.append_child("prop");
+    pod_prop.append_attribute("id")    = "pod_size";
+    pod_prop.append_attribute("value") = std::to_string(pod_size).c_str();
+
+    // auto host = cluster.append_child("host");
+
+    appendMasterZone(big_zone);
+
+    savePlatform(doc, outfile_path);
+}
+
+/* A bandwidth like "300Gbps" or "25GBps" in bit/s */
+static double parseBandwidth(const std::string& bandwidth) {
+    static const std::string prefixes = "kMGTPE";
+    size_t unit_begin = 0;
+    double value = std::stod(bandwidth, &unit_begin);
+    std::string unit = bandwidth.substr(unit_begin);
+    if (not unit.empty() and prefixes.find(unit[0]) != std::string::npos) {
+	value *= pow(1000.0, prefixes.find(unit[0]) + 1);
+	unit.erase(0, 1);
+    }
+    if (unit == "Bps") return value * 8;
+    if (unit == "bps") return value;
+    throw std::invalid_argument("Invalid bandwidth " + bandwidth);
+}
+
+static std::string formatBandwidth(double bps) {
+    std::ostringstream bandwidth;
+    bandwidth.precision(12);
+    bandwidth << bps / 1e9 << "Gbps";
+    return bandwidth.str();
+}
+
+/* A pair of links, one per direction, as SPLITDUPLEX would create, with their DLPS tracking prop */
+static void appendLinkPair(pugi::xml_node& zone, const std::string& id, const std::string& bandwidth, const std::string& latency, bool dlps) {
+    for (const char* direction : {"_UP", "_DOWN"}) {
+	auto link = zone.append_child("link");
+	link.append_attribute("id")             = (id + direction).c_str();
+	link.append_attribute("bandwidth")      = bandwidth.c_str();
+	link.append_attribute("latency")        = latency.c_str();
+	link.append_attribute("sharing_policy") = "SHARED";
+	auto dlps_prop = link.append_child("prop");
+	dlps_prop.append_attribute("id")    = "dlps";
+	dlps_prop.append_attribute("value") = dlps ? "1" : "0";
+    }
+}
+
+/* Routes both ways between two neighbours, up the link pair from src and down it from dst */
+static void appendRoutePair(pugi::xml_node& zone, const std::string& src, const std::string& dst, const std::string& link) {
+    for (int reverse = 0; reverse < 2; reverse++) {
+	auto route = zone.append_child("route");
+	route.append_attribute("src")         = (reverse ? dst : src).c_str();
+	route.append_attribute("dst")         = (reverse ? src : dst).c_str();
+	route.append_attribute("symmetrical") = "NO";
+	route.append_child("link_ctn").append_attribute("id").set_value((link + (reverse ? "_DOWN" : "_UP")).c_str());
+    }
+}
+
+/*
+ * A leaf-spine platform described by a JSON config, e.g. configs/leaf_spine_1024.json:
+ *     name:         output file name, platforms/<name>.xml
+ *     leaf_size:    nodes per leaf switch, each leaf has a link to every spine
+ *     spines:       number of spine switches
+ *     node_classes: [{name, count, speed, cores}], numbered node-0... in order
+ *     tiers:        {host: {bandwidth, latency, dlps}, spine: {bandwidth or oversubscription, latency, dlps}}
+ * Without a spine bandwidth, the uplinks of a leaf carry its host bandwidth divided by
+ * the oversubscription ratio. Links have a dlps prop, 1 on the tiers whose load is tracked.
+ *
+ * SimGrid routes are single-path, so the spread over the spines is static, ECMP-like:
+ * each leaf is a zone, the spines and the gateway router share a core zone, and the
+ * traffic between leaves l1 and l2 crosses spine (l1 + l2) % spines, the traffic
+ * between leaf l and the gateway spine l % spines. Every leaf then uses all of its
+ * uplinks evenly, which the oversubscription ratio assumes.
+ */
+static void generatePlatformFromConfig(const std::string& config_file) {
+
+    std::ifstream file(config_file);
+    if (not file) {
+	throw std::invalid_argument("Cannot open " + config_file);
+    }
+    nlohmann::json config;
+    file >> config;
+
+    std::string name = config.at("name");
+    long leaf_size = config.at("leaf_size");
+    long num_spines = config.at("spines");
+    if (leaf_size < 1 or num_spines < 1) {
+	throw std::invalid_argument("leaf_size and spines must be at least 1 in " + config_file);
+    }
+
+    const nlohmann::json& host_tier = config.at("tiers").at("host");
+    const nlohmann::json& spine_tier = config.at("tiers").at("spine");
+    std::string host_bandwidth = host_tier.at("bandwidth");
+    std::string host_latency = host_tier.value("latency", "0us");
+    std::string spine_latency = spine_tier.value("latency", "0us");
+    std::string spine_bandwidth = spine_tier.contains("bandwidth") ? spine_tier.at("bandwidth").get<std::string>() :
+	formatBandwidth(parseBandwidth(host_bandwidth) * leaf_size / (spine_tier.value("oversubscription", 1.0) * num_spines));
+
+    std::string outfile_path = "platforms/" + name + ".xml";
+    std::cerr << "Generating: " << outfile_path << " (" << leaf_size << " nodes per leaf, " << num_spines << " spines of " << spine_bandwidth << ")" << std::endl;
+
+    /* Node classes, numbered in order */
+    std::vector<std::pair<std::string, std::string>> node_speeds_cores;
+    std::vector<std::string> node_class_names;
+    for (auto& node_class : config.at("node_classes")) {
+	long count = node_class.at("count");
+	for (long i = 0; i < count; i++) {
+	    node_speeds_cores.push_back(std::make_pair(node_class.value("speed", "1f"), std::to_string(node_class.value("cores", 96))));
+	    node_class_names.push_back(node_class.value("name", "default"));
+	}
+    }
+    long num_machine = node_speeds_cores.size();
+    long num_leaves = (num_machine + leaf_size - 1) / leaf_size;
+
+    pugi::xml_document doc;
+    auto big_zone = newPlatform(doc);
+
+    auto cluster_zone = big_zone.append_child("zone");
+    cluster_zone.append_attribute("id")      = "Computation";
+    cluster_zone.append_attribute("routing") = "Full";
+
+    /* One zone per leaf: its nodes, their host tier links and loopbacks, and a route
+     * between every two of them through the leaf */
+    for (long l = 0; l < num_leaves; l++) {
+	std::string leaf = "leaf-" + std::to_string(l);
+	auto leaf_zone = cluster_zone.append_child("zone");
+	leaf_zone.append_attribute("id")      = (leaf + "_zone").c_str();
+	leaf_zone.append_attribute("routing") = "Full";
+
+	auto pod_prop = leaf_zone.append_child("prop");
+	pod_prop.append_attribute("id")    = "pod_size";
+	pod_prop.append_attribute("value") = std::to_string(leaf_size).c_str();
+
+	long first = l * leaf_size;
+	long last = std::min(num_machine, first + leaf_size);
+	for (long n = first; n < last; n++) {
+	    auto host = leaf_zone.append_child("host");
+	    host.append_attribute("id")    = ("node-" + std::to_string(n)).c_str();
+	    host.append_attribute("speed") = node_speeds_cores[n].first.c_str();
+	    host.append_attribute("core")  = node_speeds_cores[n].second.c_str();
+	    auto class_prop = host.append_child("prop");
+	    class_prop.append_attribute("id")    = "node_class";
+	    class_prop.append_attribute("value") = node_class_names[n].c_str();
+	}
+	leaf_zone.append_child("router").append_attribute("id") = leaf.c_str();
+
+	for (long n = first; n < last; n++) {
+	    std::string node = "node-" + std::to_string(n);
+	    appendLinkPair(leaf_zone, node + "_leaf", host_bandwidth, host_latency, host_tier.value("dlps", false));
+
+	    auto loopback = leaf_zone.append_child("link");
+	    loopback.append_attribute("id")             = (node + "_loopback").c_str();
+	    loopback.append_attribute("bandwidth")      = "1000EBps";
+	    loopback.append_attribute("latency")        = "0us";
+	    loopback.append_attribute("sharing_policy") = "FATPIPE";
+	}
+
+	/* Routes after all the links, as the DTD wants them */
+	for (long n = first; n < last; n++) {
+	    std::string node = "node-" + std::to_string(n);
+	    appendRoutePair(leaf_zone, node, leaf, node + "_leaf");
+	    for (long m = first; m < last; m++) {
+		std::string other = "node-" + std::to_string(m);
+		auto route = leaf_zone.append_child("route");
+		route.append_attribute("src")         = node.c_str();
+		route.append_attribute("dst")         = other.c_str();
+		route.append_attribute("symmetrical") = "NO";
+		if (m == n) {
+		    route.append_child("link_ctn").append_attribute("id").set_value((node + "_loopback").c_str());
+		} else {
+		    route.append_child("link_ctn").append_attribute("id").set_value((node + "_leaf_UP").c_str());
+		    route.append_child("link_ctn").append_attribute("id").set_value((other + "_leaf_DOWN").c_str());
+		}
+	    }
+	}
+    }
+
+    /* The spines and the gateway, outside of both tiers */
+    auto core_zone = cluster_zone.append_child("zone");
+    core_zone.append_attribute("id")      = "spine_zone";
+    core_zone.append_attribute("routing") = "Full";
+    core_zone.append_child("router").append_attribute("id") = "cluster_router";
+    for (long s = 0; s < num_spines; s++) {
+	core_zone.append_child("router").append_attribute("id") = ("spine-" + std::to_string(s)).c_str();
+    }
+    for (long s = 0; s < num_spines; s++) {
+	auto gateway = core_zone.append_child("link");
+	gateway.append_attribute("id")             = ("spine-" + std::to_string(s) + "_gateway").c_str();
+	gateway.append_attribute("bandwidth")      = "1000EBps";
+	gateway.append_attribute("latency")        = "0us";
+	gateway.append_attribute("sharing_policy") = "FATPIPE";
+	auto dlps_prop = gateway.append_child("prop");
+	dlps_prop.append_attribute("id")    = "dlps";
+	dlps_prop.append_attribute("value") = "0";
+    }
+    for (long s = 0; s < num_spines; s++) {
+	std::string spine = "spine-" + std::to_string(s);
+	auto route = core_zone.append_child("route");
+	route.append_attribute("src") = "cluster_router";
+	route.append_attribute("dst") = spine.c_str();
+	route.append_child("link_ctn").append_attribute("id").set_value((spine + "_gateway").c_str());
+    }
+
+    /* The spine tier */
+    for (long l = 0; l < num_leaves; l++) {
+	for (long s = 0; s < num_spines; s++) {
+	    std::string leaf_spine = "leaf-" + std::to_string(l) + "_spine-" + std::to_string(s);
+	    appendLinkPair(cluster_zone, leaf_spine, spine_bandwidth, spine_latency, spine_tier.value("dlps", true));
+	}
+    }
+
+    /* Leaf to leaf over the spine of the pair, and leaf to gateway over the spine of the leaf */
+    auto appendZoneRoute = [&](const std::string& src, const std::string& dst, const std::string& gw_src, const std::string& gw_dst,
+			       const std::vector<std::string>& links) {
+	auto route = cluster_zone.append_child("zoneRoute");
+	route.append_attribute("src")         = src.c_str();
+	route.append_attribute("dst")         = dst.c_str();
+	route.append_attribute("gw_src")      = gw_src.c_str();
+	route.append_attribute("gw_dst")      = gw_dst.c_str();
+	route.append_attribute("symmetrical") = "NO";
+	for (auto& link : links) {
+	    route.append_child("link_ctn").append_attribute("id").set_value(link.c_str());
+	}
+    };
+    for (long l1 = 0; l1 < num_leaves; l1++) {
+	std::string leaf1 = "leaf-" + std::to_string(l1);
+	for (long l2 = 0; l2 < num_leaves; l2++) {
+	    if (l2 == l1) continue;
+	    std::string leaf2 = "leaf-" + std::to_string(l2);
+	    std::string spine = "spine-" + std::to_string((l1 + l2) % num_spines);
+	    appendZoneRoute(leaf1 + "_zone", leaf2 + "_zone", leaf1, leaf2, {leaf1 + "_" + spine + "_UP", leaf2 + "_" + spine + "_DOWN"});
+	}
+	std::string spine = "spine-" + std::to_string(l1 % num_spines);
+	appendZoneRoute(leaf1 + "_zone", "spine_zone", leaf1, spine, {leaf1 + "_" + spine + "_UP"});
+	appendZoneRoute("spine_zone", leaf1 + "_zone", spine, leaf1, {leaf1 + "_" + spine + "_DOWN"});
+    }
+
+    appendMasterZone(big_zone);
+
+    savePlatform(doc, outfile_path);
+}
+
+int main(int argc, char **argv) {
+
+    int num_threads = 1;
+    std::vector<char*> args;
+    std::vector<std::string> config_files;
+    for (int i = 1; i < argc; i++) {
+	if (strncmp(argv[i], "--threads=", 10) == 0) {
+	    num_threads = std::max(1, std::atoi(argv[i] + 10));
+	} else if (strncmp(argv[i], "--config=", 9) == 0) {
+	    config_files.push_back(argv[i] + 9);
+	} else {
+	    args.push_back(argv[i]);
+	}
+    }
+
+    if (not config_files.empty() and not args.empty()) {
+	std::cerr << "--config cannot be combined with a topology and a number of machines" << std::endl;
+	exit(1);
+    }
+
+    if (not config_files.empty()) {
+	for (auto& config_file : config_files) {
+	    try {
+		generatePlatformFromConfig(config_file);
+	    } catch (std::exception &e) {
+		std::cerr << "Cannot generate a platform from " << config_file << ": " << e.what() << std::endl;
+		exit(1);
+	    }
+	}
+	return 0;
+    }
+
+    if (args.size() != 2) {
+	std::cerr << "Usage: " << argv[0] << " <topology>[,<topology>...] <number of machines>[,<number of machines>...] [--threads=N]" << std::endl;
+	std::cerr << "       " << argv[0] << " --config=<platform JSON> [--config=<platform JSON>...]" << std::endl;
+        exit(1);
+    }
+
+    std::set<std::string> supported_topology = {"FAT_TREE", "DRAGONFLY", "TORUS"};
+    std::vector<std::string> topo_names;
+    std::locale loc;
+    for (char* topology = strtok(args[0], ","); topology; topology = strtok(nullptr, ",")) {
+	std::string topo_name = "";
+	for (char* c = topology; *c; c++) {
+	    topo_name.push_back(std::toupper(*c, loc));
+	}
+	if (supported_topology.find(topo_name) == supported_topology.end()) {
+	    std::cerr << "Invalid topology name. Currently support ";
+	    for (auto it = supported_topology.begin(); it != supported_topology.end(); ++it) {
+		std::cerr << "[" << *it << "] ";
+	    }
+	    std::cerr << std::endl;
+	    exit(1);
+	}
+	topo_names.push_back(topo_name);
+    }
+
+    std::vector<long> num_machines;
+    for (char* number = strtok(args[1], ","); number; number = strtok(nullptr, ",")) {
+	long num_machine = std::atol(number);
+	if (num_machine < 4) {
+	    std::cerr << "Invalid number of machines " << number << ". Must be at least 4." << std::endl;
+	    exit(1);
+	}
+	num_machines.push_back(num_machine);
+    }
+
+    /* Every topology and size of the sweep, shared out to the threads */
+    std::vector<std::pair<std::string, long>> platforms;
+    for (auto& topo_name : topo_names) {
+	for (long num_machine : num_machines) {
+	    platforms.push_back(std::make_pair(topo_name, num_machine));
+	}
+    }
+
+    std::atomic<size_t> next_platform(0);
+    std::vector<std::future<void>> workers;
+    for (int t = 0; t < std::min<int>(num_threads, platforms.size()); t++) {
+	workers.push_back(std::async(std::launch::async, [&]() {
+	    for (size_t i = next_platform++; i < platforms.size(); i = next_platform++) {
+		generatePlatform(platforms[i].first, platforms[i].second);
+	    }
+	}));
+    }
+    for (auto& worker : workers) {
+	worker.get();
+    }
 
     return 0;
 }
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include "AlibabaJob.h"
+#include "CheckpointIO.h"
 #include "helper/helper.h"
 
 /*double AlibabaJob::generateFileSize(std::string job_id, std::string file_id) { // File size in KB
@@ -35,19 +36,127 @@ void AlibabaJob::addControlDependency(wrench::WorkflowTask* src, wrench::Workflo
     }
 }
 
+/* Add the control dependencies of all task instances at once. Task-level edges
+ * are reduced transitively first (reachability bitsets over a topological order),
+ * then every kept edge <child task, parent task> becomes an edge from each parent
+ * instance to each child instance. Since instances of a task share the same
+ * edges, this is also the transitive reduction of the instance DAG, without any
+ * doesPathExist() calls. Returns false if the task dependencies contain a cycle. */
+bool AlibabaJob::addTaskDependencies() {
+
+    /* Number the tasks that have instances; edges to tasks without any are dropped */
+    std::unordered_map<uint32_t, int> node_of;
+    std::vector<std::vector<int>> children;
+    std::vector<int> in_degree;
+    auto getNode = [&](uint32_t task_id) {
+        auto it = node_of.find(task_id);
+        if (it != node_of.end()) return it->second;
+        int node = children.size();
+        node_of[task_id] = node;
+        children.emplace_back();
+        in_degree.push_back(0);
+        return node;
+    };
+    for (auto& d : this->getDependencyMap()) {
+        if (d.first == d.second) continue; // a task cannot wait for itself
+        if (this->getTaskInstances(d.first).empty() || this->getTaskInstances(d.second).empty()) continue;
+        int parent = getNode(d.second);
+        int child = getNode(d.first);
+        children[parent].push_back(child);
+        in_degree[child]++;
+    }
+    int num_nodes = children.size();
+
+    /* Topological order (Kahn) */
+    std::vector<int> order;
+    order.reserve(num_nodes);
+    for (int v = 0; v < num_nodes; v++) {
+        if (in_degree[v] == 0) order.push_back(v);
+    }
+    for (size_t i = 0; i < order.size(); i++) {
+        for (int c : children[order[i]]) {
+            if (--in_degree[c] == 0) order.push_back(c);
+        }
+    }
+    if ((int) order.size() != num_nodes) {
+        return false;
+    }
+    std::vector<int> rank(num_nodes);
+    for (int i = 0; i < num_nodes; i++) {
+        rank[order[i]] = i;
+    }
+
+    /* Walk in reverse topological order. Children are visited nearest first, so a
+     * child already reachable through an earlier one only has a redundant edge. */
+    size_t words = (num_nodes + 63) / 64;
+    std::vector<uint64_t> reach((size_t) num_nodes * words, 0);
+    std::unordered_set<uint64_t> kept_edges; // <parent node, child node>
+    for (int i = num_nodes - 1; i >= 0; i--) {
+        int v = order[i];
+        uint64_t* reach_v = &reach[(size_t) v * words];
+        std::sort(children[v].begin(), children[v].end(), [&rank](int a, int b) { return rank[a] < rank[b]; });
+        for (int c : children[v]) {
+            if (reach_v[c / 64] & (1ULL << (c % 64))) continue;
+            kept_edges.insert(((uint64_t) v << 32) | c);
+            const uint64_t* reach_c = &reach[(size_t) c * words];
+            for (size_t w = 0; w < words; w++) {
+                reach_v[w] |= reach_c[w];
+            }
+            reach_v[c / 64] |= 1ULL << (c % 64);
+        }
+    }
+
+    /* Expand the kept task edges to instance edges, in dependency map order */
+    for (auto& d : this->getDependencyMap()) {
+        auto itc = node_of.find(d.first);
+        auto itp = node_of.find(d.second);
+        if (itc == node_of.end() || itp == node_of.end()) continue;
+        if (kept_edges.find(((uint64_t) itp->second << 32) | itc->second) == kept_edges.end()) continue;
+        for (auto child_id : this->getTaskInstances(d.first)) {
+            for (auto parent_id : this->getTaskInstances(d.second)) {
+                this->addControlDependency(this->instances[parent_id], this->instances[child_id], true);
+            }
+        }
+    }
+
+    return true;
+}
+
 void AlibabaJob::printPairs() { // only for debugging
     std::cerr << "Dependency pairs:" << std::endl;
-    for (auto it = this->dependencies.begin(); it != this->dependencies.end(); ++it) {
-        std::cerr << "{" << it->first << "," << it->second << "} ";
+    for (auto it = this->getDependencyMap().begin(); it != this->getDependencyMap().end(); ++it) {
+        std::cerr << "{" << this->task_names->getName(it->first) << "," << this->task_names->getName(it->second) << "} ";
     }
     std::cerr << std::endl << "Task instance pairs:" << std::endl;
     for (auto it = this->task_instances.begin(); it != this->task_instances.end(); ++it) {
-        std::cerr << "{" << it->first << "," << it->second << "} ";
+        for (auto instance_id : it->second) {
+            std::cerr << "{" << this->task_names->getName(it->first) << "," << this->instances[instance_id]->getID() << "} ";
+        }
     }
     std::cerr << std::endl;
 }
 
-AlibabaJob* AlibabaJob::updateJob(std::string task_name, std::string instance_name, double start_time, double end_time, double avg_cpu, double avg_mem, long host_id) {
+const std::vector<std::pair<uint32_t, uint32_t>>& AlibabaJob::getDependencyMap() {
+    if (not this->dependencies_sorted) {
+        /* Same order as the former std::set of name pairs, so that edges are added in the same order */
+        auto names = this->task_names;
+        std::sort(this->dependencies.begin(), this->dependencies.end(),
+                  [names](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+            int cmp = names->getName(a.first).compare(names->getName(b.first));
+            return cmp < 0 || (cmp == 0 && names->getName(a.second) < names->getName(b.second));
+        });
+        this->dependencies_sorted = true;
+    }
+    return this->dependencies;
+}
+
+const std::vector<uint32_t>& AlibabaJob::getTaskInstances(uint32_t task_id) {
+    static const std::vector<uint32_t> no_instances;
+    auto it = this->task_instances.find(task_id);
+    return it != this->task_instances.end() ? it->second : no_instances;
+}
+
+uint32_t AlibabaJob::addInstance(const std::string& instance_name, double start_time, double end_time, double avg_cpu, double avg_mem, long host_id) {
 
     wrench::WorkflowTask* task = this->addTask(instance_name, max(end_time - start_time, 0.0), 1, 1, avg_mem);
     task->setAverageCPU(avg_cpu);
@@ -59,29 +168,109 @@ AlibabaJob* AlibabaJob::updateJob(std::string task_name, std::string instance_na
     task->setStaticEndTime(end_time);
     task->setStaticStartTime(start_time);
 
+    uint32_t instance_id = this->instances.size();
+    this->instances.push_back(task);
+    return instance_id;
+}
+
+AlibabaJob* AlibabaJob::updateJob(std::string_view task_name, const std::string& instance_name, double start_time, double end_time, double avg_cpu, double avg_mem, long host_id) {
+
+    uint32_t instance_id = this->addInstance(instance_name, start_time, end_time, avg_cpu, avg_mem, host_id);
+
     /* Update job start time */
     if (start_time < this->getSubmittedTime()) {
 	this->setSubmittedTime(start_time);
     }
 
     /* Remove first letter and split into individual task IDs */
-    std::vector<std::string> split_names;
     if (task_name.length() < 4 || (task_name.length() >= 4 && task_name.substr(0, 4).compare("task") != 0)) {
-        split_names = splitString(task_name.erase(0,1), "_");
-    }
+        std::string_view split_names = task_name.substr(std::min<size_t>(1, task_name.length()));
+        size_t pos = split_names.find('_');
+        uint32_t task_id = this->task_names->intern(split_names.substr(0, pos));
 
-    if (split_names.size() > 0) {
-        if (split_names.size() > 1) {
-            /* Update dependency map */
-            for (int i = 1; i < split_names.size(); i++) {
-                this->dependencies.insert(std::make_pair(split_names.front(), split_names.at(i)));
+        /* Update dependency map */
+        while (pos != std::string_view::npos) {
+            split_names.remove_prefix(pos + 1);
+            pos = split_names.find('_');
+            uint32_t parent_id = this->task_names->intern(split_names.substr(0, pos));
+            if (this->dependency_keys.insert(((uint64_t) task_id << 32) | parent_id).second) {
+                this->dependencies.push_back(std::make_pair(task_id, parent_id));
+                this->dependencies_sorted = false;
             }
         }
 
         /* Update task instances map */
-        this->task_instances.emplace(split_names.front(), instance_name);
+        this->task_instances[task_id].push_back(instance_id);
     }
 
     return this;
 }
 
+/* Compact binary form of a queued job for checkpoints: its instances, which of
+ * them belong to which task, and the task dependencies, all by name */
+void AlibabaJob::save(std::ostream& out) {
+    writeBinary(out, this->getName());
+    writeBinary(out, this->getSubmittedTime());
+
+    writeBinary(out, (uint32_t) this->instances.size());
+    for (auto task : this->instances) {
+	writeBinary(out, task->getID());
+	writeBinary(out, task->getStaticStartTime());
+	writeBinary(out, task->getStaticEndTime());
+	writeBinary(out, task->getAverageCPU());
+	writeBinary(out, task->getMemoryRequirement());
+	writeBinary(out, (long) task->getStaticHost());
+    }
+
+    writeBinary(out, (uint32_t) this->task_instances.size());
+    for (auto& t : this->task_instances) {
+	writeBinary(out, this->task_names->getName(t.first));
+	writeBinary(out, (uint32_t) t.second.size());
+	for (auto instance_id : t.second) {
+	    writeBinary(out, instance_id);
+	}
+    }
+
+    writeBinary(out, (uint32_t) this->dependencies.size());
+    for (auto& d : this->dependencies) {
+	writeBinary(out, this->task_names->getName(d.first));
+	writeBinary(out, this->task_names->getName(d.second));
+    }
+}
+
+AlibabaJob* AlibabaJob::load(std::istream& in, StringInterner* task_names) {
+    AlibabaJob* job = new AlibabaJob(task_names);
+    job->setName(readBinaryString(in));
+    job->setSubmittedTime(readBinary<double>(in));
+
+    uint32_t num_instances = readBinary<uint32_t>(in);
+    for (uint32_t i = 0; i < num_instances; i++) {
+	std::string instance_name = readBinaryString(in);
+	double start_time = readBinary<double>(in);
+	double end_time = readBinary<double>(in);
+	double avg_cpu = readBinary<double>(in);
+	double avg_mem = readBinary<double>(in);
+	long host_id = readBinary<long>(in);
+	job->addInstance(instance_name, start_time, end_time, avg_cpu, avg_mem, host_id);
+    }
+
+    uint32_t num_tasks = readBinary<uint32_t>(in);
+    for (uint32_t i = 0; i < num_tasks; i++) {
+	auto& task_instances = job->task_instances[task_names->intern(readBinaryString(in))];
+	uint32_t count = readBinary<uint32_t>(in);
+	for (uint32_t j = 0; j < count; j++) {
+	    task_instances.push_back(readBinary<uint32_t>(in));
+	}
+    }
+
+    uint32_t num_dependencies = readBinary<uint32_t>(in);
+    for (uint32_t i = 0; i < num_dependencies; i++) {
+	uint32_t task_id = task_names->intern(readBinaryString(in));
+	uint32_t parent_id = task_names->intern(readBinaryString(in));
+	job->dependency_keys.insert(((uint64_t) task_id << 32) | parent_id);
+	job->dependencies.push_back(std::make_pair(task_id, parent_id));
+    }
+    job->dependencies_sorted = job->dependencies.empty();
+
+    return job;
+}
@@ -1,20 +1,38 @@
 #include <wrench-dev.h>
+#include <string_view>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "StringInterner.h"
 
 
 class AlibabaJob : public wrench::Workflow {
 
     public:
-        AlibabaJob* updateJob(std::string task_name, std::string instance_name, double start_time, double end_time, double avg_cpu, double avg_mem, long host_id);
-        std::set<std::pair<std::string, std::string>> getDependencyMap() {
-                return this->dependencies; }
-        std::multimap<std::string, std::string> getTaskInstanceMap() {
-                return this->task_instances; }
+        explicit AlibabaJob(StringInterner* task_names) : task_names(task_names) {}
+
+        AlibabaJob* updateJob(std::string_view task_name, const std::string& instance_name, double start_time, double end_time, double avg_cpu, double avg_mem, long host_id);
+        /* <child task, parent task> pairs, ordered by task name */
+        const std::vector<std::pair<uint32_t, uint32_t>>& getDependencyMap();
+        const std::vector<uint32_t>& getTaskInstances(uint32_t task_id);
+        wrench::WorkflowTask* getInstance(uint32_t instance_id) { return this->instances[instance_id]; }
 	void addControlDependency(wrench::WorkflowTask* src, wrench::WorkflowTask* dest, bool redundant_dependencies = false);
+        bool addTaskDependencies();
         void printPairs(); // only for debugging
+        void save(std::ostream& out);
+        static AlibabaJob* load(std::istream& in, StringInterner* task_names);
 //	double generateFileSize(std::string seed1, std::string seed2);
 
     private:
-        std::set<std::pair<std::string, std::string>> dependencies;
-        std::multimap<std::string, std::string> task_instances;
+        uint32_t addInstance(const std::string& instance_name, double start_time, double end_time, double avg_cpu, double avg_mem, long host_id);
+
+        StringInterner* task_names;
+        std::vector<std::pair<uint32_t, uint32_t>> dependencies;
+        std::unordered_set<uint64_t> dependency_keys;
+        bool dependencies_sorted = true;
+        std::vector<wrench::WorkflowTask*> instances; // indexed by per-job instance id
+        std::unordered_map<uint32_t, std::vector<uint32_t>> task_instances;
 
 };
@@ -0,0 +1,82 @@
+#ifndef TRACE_TO_WORKFLOWS_BOUNDEDQUEUE_H
+#define TRACE_TO_WORKFLOWS_BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/* Bounded lock-free multi-producer/multi-consumer queue (D. Vyukov). Each cell
+ * carries a sequence number telling whether it is free for the producer or
+ * filled for the consumer of a given lap. The capacity is rounded up to a
+ * power of two; tryPush() fails instead of blocking when the queue is full. */
+template <typename T>
+class BoundedQueue {
+
+    public:
+        explicit BoundedQueue(size_t capacity) {
+            size_t size = 2;
+            while (size < capacity) size <<= 1;
+            this->mask = size - 1;
+            this->cells.reset(new Cell[size]);
+            for (size_t i = 0; i < size; i++) {
+                this->cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        bool tryPush(const T& data) {
+            Cell* cell;
+            size_t position = this->enqueue_position.load(std::memory_order_relaxed);
+            while (true) {
+                cell = &this->cells[position & this->mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t) sequence - (intptr_t) position;
+                if (diff == 0) {
+                    if (this->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    return false; // full
+                } else {
+                    position = this->enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data = data;
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool tryPop(T& data) {
+            Cell* cell;
+            size_t position = this->dequeue_position.load(std::memory_order_relaxed);
+            while (true) {
+                cell = &this->cells[position & this->mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t) sequence - (intptr_t) (position + 1);
+                if (diff == 0) {
+                    if (this->dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                } else if (diff < 0) {
+                    return false; // empty
+                } else {
+                    position = this->dequeue_position.load(std::memory_order_relaxed);
+                }
+            }
+            data = cell->data;
+            cell->sequence.store(position + this->mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        size_t getCapacity() const { return this->mask + 1; }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T data;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask;
+        alignas(64) std::atomic<size_t> enqueue_position{0};
+        alignas(64) std::atomic<size_t> dequeue_position{0};
+};
+
+#endif // TRACE_TO_WORKFLOWS_BOUNDEDQUEUE_H
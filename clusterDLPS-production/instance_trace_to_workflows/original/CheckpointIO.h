@@ -0,0 +1,45 @@
+#ifndef TRACE_TO_WORKFLOWS_CHECKPOINTIO_H
+#define TRACE_TO_WORKFLOWS_CHECKPOINTIO_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/* Raw little helpers for the binary checkpoint of trace_to_workflows. Values
+ * are written in host byte order, a checkpoint is only read back on the
+ * machine that wrote it. */
+template <typename T>
+inline void writeBinary(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline void writeBinary(std::ostream& out, std::string_view value) {
+    writeBinary(out, (uint32_t) value.size());
+    out.write(value.data(), value.size());
+}
+
+inline void writeBinary(std::ostream& out, const std::string& value) {
+    writeBinary(out, std::string_view(value));
+}
+
+template <typename T>
+inline T readBinary(std::istream& in) {
+    T value;
+    if (not in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+	throw std::runtime_error("Truncated checkpoint");
+    }
+    return value;
+}
+
+inline std::string readBinaryString(std::istream& in) {
+    std::string value(readBinary<uint32_t>(in), '\0');
+    if (not in.read(&value[0], value.size())) {
+	throw std::runtime_error("Truncated checkpoint");
+    }
+    return value;
+}
+
+#endif // TRACE_TO_WORKFLOWS_CHECKPOINTIO_H
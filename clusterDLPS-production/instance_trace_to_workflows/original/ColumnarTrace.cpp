@@ -0,0 +1,286 @@
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <string>
+
+#include "helper/helper.h"
+#include "ColumnarTrace.h"
+
+const char ColumnarTrace::magic[8] = {'A', 'L', 'I', 'C', 'O', 'L', '0', '1'};
+
+std::vector<ColumnSpec> getColumnarSchema(const std::string& schema_name, int& num_csv_columns) {
+    if (schema_name == "batch_instance") { // trace/batch_instance.csv
+	num_csv_columns = 14;
+	return {{"instance_name", ColumnType::STRING, 0},
+		{"task_name", ColumnType::DICT, 1},
+		{"job_name", ColumnType::DICT, 2},
+		{"status", ColumnType::DICT, 4},
+		{"start_time", ColumnType::DOUBLE, 5},
+		{"end_time", ColumnType::DOUBLE, 6},
+		{"host_id", ColumnType::HOST, 7},
+		{"seq_no", ColumnType::LONG, 8},
+		{"cpu_avg", ColumnType::DOUBLE, 10},
+		{"mem_avg", ColumnType::DOUBLE, 12}};
+    } else if (schema_name == "sample_instance") { // trace/<N>_sample/batch_instace.csv
+	num_csv_columns = 7;
+	return {{"start_time", ColumnType::DOUBLE, 0},
+		{"job_name", ColumnType::DICT, 1},
+		{"task_name", ColumnType::DICT, 2},
+		{"instance_name", ColumnType::STRING, 3},
+		{"duration", ColumnType::DOUBLE, 4},
+		{"cpu_avg", ColumnType::DOUBLE, 5},
+		{"mem_avg", ColumnType::DOUBLE, 6}};
+    } else if (schema_name == "container_meta") { // trace/container_meta.csv
+	num_csv_columns = 8;
+	return {{"container_id", ColumnType::DICT, 0},
+		{"host_id", ColumnType::HOST, 1},
+		{"time_stamp", ColumnType::LONG, 2},
+		{"status", ColumnType::DICT, 4},
+		{"cpu_request", ColumnType::LONG, 5},
+		{"cpu_limit", ColumnType::LONG, 6}};
+    }
+    throw std::invalid_argument("Unknown trace schema \"" + schema_name + "\"");
+}
+
+ColumnarTrace::ColumnarTrace(const std::string& file_path) : file(file_path), file_path(file_path) {
+    if (this->file.getSize() < sizeof(FileHeader) || memcmp(this->file.begin(), magic, sizeof(magic)) != 0) {
+	throw std::invalid_argument(file_path + " is not a columnar trace");
+    }
+    this->header = reinterpret_cast<const FileHeader*>(this->file.begin());
+    this->columns = reinterpret_cast<const ColumnHeader*>(this->file.begin() + sizeof(FileHeader));
+}
+
+int ColumnarTrace::findColumn(std::string_view name) const {
+    for (uint32_t i = 0; i < this->header->num_columns; i++) {
+	if (name == this->columns[i].name) return i;
+    }
+    throw std::invalid_argument("No column \"" + std::string(name) + "\" in " + this->file_path);
+}
+
+ColumnType ColumnarTrace::getColumnType(int column) const {
+    return this->columns[column].type;
+}
+
+const ColumnarTrace::ColumnHeader& ColumnarTrace::getColumnHeader(int column, ColumnType type) const {
+    const ColumnHeader& c = this->columns[column];
+    bool is_long = c.type == ColumnType::LONG || c.type == ColumnType::HOST;
+    if (c.type != type && not (type == ColumnType::LONG && is_long)) {
+	throw std::invalid_argument("Column \"" + std::string(c.name) + "\" of " + this->file_path + " has another type");
+    }
+    return c;
+}
+
+ColumnarRowGroup ColumnarTrace::getRowGroup(uint64_t group) const {
+    uint64_t begin = group * this->header->rows_per_group;
+    return {begin, std::min(begin + this->header->rows_per_group, this->header->num_rows)};
+}
+
+double ColumnarTrace::getMin(uint64_t group, int column) const {
+    const double* zone_map = reinterpret_cast<const double*>(this->at(this->header->zone_map_offset));
+    return zone_map[(group * this->header->num_columns + column) * 2];
+}
+
+double ColumnarTrace::getMax(uint64_t group, int column) const {
+    const double* zone_map = reinterpret_cast<const double*>(this->at(this->header->zone_map_offset));
+    return zone_map[(group * this->header->num_columns + column) * 2 + 1];
+}
+
+const double* ColumnarTrace::getDoubles(int column) const {
+    return reinterpret_cast<const double*>(this->at(this->getColumnHeader(column, ColumnType::DOUBLE).data_offset));
+}
+
+const int64_t* ColumnarTrace::getLongs(int column) const {
+    return reinterpret_cast<const int64_t*>(this->at(this->getColumnHeader(column, ColumnType::LONG).data_offset));
+}
+
+const uint32_t* ColumnarTrace::getIds(int column) const {
+    return reinterpret_cast<const uint32_t*>(this->at(this->getColumnHeader(column, ColumnType::DICT).data_offset));
+}
+
+/* Dictionary layout: uint64 count, uint64 offsets[count + 1], then the name bytes */
+std::string_view ColumnarTrace::getName(int column, uint32_t id) const {
+    const uint64_t* dictionary = reinterpret_cast<const uint64_t*>(
+	    this->at(this->getColumnHeader(column, ColumnType::DICT).dictionary_offset));
+    const char* bytes = reinterpret_cast<const char*>(dictionary + dictionary[0] + 2);
+    return std::string_view(bytes + dictionary[id + 1], dictionary[id + 2] - dictionary[id + 1]);
+}
+
+std::string_view ColumnarTrace::getString(int column, uint64_t row) const {
+    if (this->columns[column].type == ColumnType::DICT) {
+	return this->getName(column, this->getIds(column)[row]);
+    }
+    const ColumnHeader& c = this->getColumnHeader(column, ColumnType::STRING);
+    const uint64_t* ends = reinterpret_cast<const uint64_t*>(this->at(c.data_offset));
+    uint64_t begin = row == 0 ? 0 : ends[row - 1];
+    return std::string_view(this->at(c.dictionary_offset) + begin, ends[row] - begin);
+}
+
+ColumnarTraceWriter::ColumnarTraceWriter(const std::string& file_path, const std::vector<ColumnSpec>& schema, uint32_t rows_per_group)
+	: file_path(file_path), columns(schema.size()), rows_per_group(std::max(1U, rows_per_group)) {
+    for (size_t i = 0; i < schema.size(); i++) {
+	if (schema[i].name.size() >= sizeof(ColumnarTrace::ColumnHeader::name)) {
+	    throw std::invalid_argument("Column name \"" + schema[i].name + "\" is too long");
+	}
+	Column& c = this->columns[i];
+	c.spec = schema[i];
+	c.data = fopen((file_path + "." + std::to_string(i) + ".tmp").c_str(), "w+");
+	if (c.spec.type == ColumnType::STRING) {
+	    c.strings = fopen((file_path + "." + std::to_string(i) + ".str.tmp").c_str(), "w+");
+	}
+	if (c.data == nullptr || (c.spec.type == ColumnType::STRING && c.strings == nullptr)) {
+	    throw std::invalid_argument("Cannot open temporary file next to " + file_path);
+	}
+    }
+    this->group_min.assign(schema.size(), std::numeric_limits<double>::infinity());
+    this->group_max.assign(schema.size(), -std::numeric_limits<double>::infinity());
+}
+
+ColumnarTraceWriter::~ColumnarTraceWriter() {
+    for (size_t i = 0; i < this->columns.size(); i++) {
+	if (this->columns[i].data) {
+	    fclose(this->columns[i].data);
+	    remove((this->file_path + "." + std::to_string(i) + ".tmp").c_str());
+	}
+	if (this->columns[i].strings) {
+	    fclose(this->columns[i].strings);
+	    remove((this->file_path + "." + std::to_string(i) + ".str.tmp").c_str());
+	}
+    }
+}
+
+void ColumnarTraceWriter::addRow(const std::string_view* fields) {
+    for (size_t i = 0; i < this->columns.size(); i++) {
+	Column& c = this->columns[i];
+	std::string_view field = fields[c.spec.csv_column];
+	double zone_value = 0;
+	switch (c.spec.type) {
+	    case ColumnType::DOUBLE: {
+		double value;
+		MappedCSVReader::parse(field, value);
+		fwrite(&value, sizeof(value), 1, c.data);
+		zone_value = value;
+		break;
+	    }
+	    case ColumnType::LONG:
+	    case ColumnType::HOST: {
+		long value = ColumnarTrace::invalid_host;
+		if (c.spec.type == ColumnType::LONG) {
+		    MappedCSVReader::parse(field, value);
+		} else {
+		    try {
+			value = parseHostId(field);
+		    } catch (const std::invalid_argument &ia) {} // e.g. instances never placed on a machine
+		}
+		int64_t stored = value;
+		fwrite(&stored, sizeof(stored), 1, c.data);
+		zone_value = value;
+		break;
+	    }
+	    case ColumnType::DICT: {
+		uint32_t id = c.dictionary.intern(field);
+		fwrite(&id, sizeof(id), 1, c.data);
+		break;
+	    }
+	    case ColumnType::STRING: {
+		fwrite(field.data(), 1, field.size(), c.strings);
+		c.string_size += field.size();
+		fwrite(&c.string_size, sizeof(c.string_size), 1, c.data);
+		break;
+	    }
+	}
+	this->group_min[i] = std::min(this->group_min[i], zone_value);
+	this->group_max[i] = std::max(this->group_max[i], zone_value);
+    }
+
+    this->num_rows++;
+    if (this->num_rows % this->rows_per_group == 0) {
+	this->closeRowGroup();
+    }
+}
+
+void ColumnarTraceWriter::closeRowGroup() {
+    for (size_t i = 0; i < this->columns.size(); i++) {
+	this->zone_map.push_back(this->group_min[i]);
+	this->zone_map.push_back(this->group_max[i]);
+	this->group_min[i] = std::numeric_limits<double>::infinity();
+	this->group_max[i] = -std::numeric_limits<double>::infinity();
+    }
+}
+
+/* Copy a temporary file to the end of out, padded to 8 bytes. Returns where it starts. */
+static uint64_t appendFile(FILE* out, FILE* in) {
+    uint64_t offset = ftell(out);
+    rewind(in);
+    std::vector<char> buffer(1 << 20);
+    size_t n;
+    while ((n = fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+	if (fwrite(buffer.data(), 1, n, out) != n) {
+	    throw std::invalid_argument("Cannot write columnar trace");
+	}
+    }
+    while (ftell(out) % 8 != 0) fputc(0, out);
+    return offset;
+}
+
+void ColumnarTraceWriter::close() {
+    if (this->num_rows % this->rows_per_group != 0) {
+	this->closeRowGroup();
+    }
+
+    FILE* out = fopen(this->file_path.c_str(), "w");
+    if (out == nullptr) {
+	throw std::invalid_argument("Cannot open file for output!");
+    }
+
+    ColumnarTrace::FileHeader header = {};
+    memcpy(header.magic, ColumnarTrace::magic, sizeof(header.magic));
+    header.num_columns = this->columns.size();
+    header.rows_per_group = this->rows_per_group;
+    header.num_rows = this->num_rows;
+    header.num_row_groups = this->zone_map.size() / (2 * this->columns.size());
+    std::vector<ColumnarTrace::ColumnHeader> column_headers(this->columns.size());
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(column_headers.data(), sizeof(ColumnarTrace::ColumnHeader), column_headers.size(), out);
+
+    for (size_t i = 0; i < this->columns.size(); i++) {
+	Column& c = this->columns[i];
+	ColumnarTrace::ColumnHeader& h = column_headers[i];
+	strncpy(h.name, c.spec.name.c_str(), sizeof(h.name) - 1);
+	h.type = c.spec.type;
+	/* addRow() does not check its writes, a full disk shows up here */
+	if (fflush(c.data) != 0 or ferror(c.data) or (c.strings and (fflush(c.strings) != 0 or ferror(c.strings)))) {
+	    fclose(out);
+	    throw std::invalid_argument("Cannot write the temporary files of column \"" + c.spec.name + "\"");
+	}
+	h.data_offset = appendFile(out, c.data);
+	if (c.spec.type == ColumnType::STRING) {
+	    h.dictionary_offset = appendFile(out, c.strings);
+	} else if (c.spec.type == ColumnType::DICT) {
+	    h.dictionary_offset = ftell(out);
+	    uint64_t count = c.dictionary.size();
+	    fwrite(&count, sizeof(count), 1, out);
+	    uint64_t end = 0;
+	    fwrite(&end, sizeof(end), 1, out);
+	    for (uint32_t id = 0; id < count; id++) {
+		end += c.dictionary.getName(id).size();
+		fwrite(&end, sizeof(end), 1, out);
+	    }
+	    for (uint32_t id = 0; id < count; id++) {
+		fwrite(c.dictionary.getName(id).data(), 1, c.dictionary.getName(id).size(), out);
+	    }
+	    while (ftell(out) % 8 != 0) fputc(0, out);
+	}
+    }
+
+    header.zone_map_offset = ftell(out);
+    fwrite(this->zone_map.data(), sizeof(double), this->zone_map.size(), out);
+
+    /* Now that all offsets are known, write the headers again */
+    rewind(out);
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(column_headers.data(), sizeof(ColumnarTrace::ColumnHeader), column_headers.size(), out);
+    if (ferror(out) || fclose(out) != 0) {
+	throw std::invalid_argument("Cannot write columnar trace");
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef TRACE_TO_WORKFLOWS_COLUMNARTRACE_H
+#define TRACE_TO_WORKFLOWS_COLUMNARTRACE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedCSVReader.h"
+#include "StringInterner.h"
+
+/* Columnar binary copy of an Alibaba CSV trace, written once by trace2columnar
+ * and memory-mapped by the converters. Rows are ordered by the start hour of their
+ * job (see csv_to_columnar.cpp), so that each row group covers a short time range;
+ * within an hour they keep the order of the CSV file.
+ *
+ * Layout: a header, one descriptor per column, then per column a fixed-width
+ * array of num_rows values (double, int64 or uint32 dictionary ids; plain
+ * strings are uint64 end offsets into a byte area), the dictionaries, and a
+ * zone map holding min/max of every numeric column for each row group. */
+enum class ColumnType : uint32_t {
+    DOUBLE = 0,
+    LONG = 1,
+    HOST = 2,   // static host id parsed from a machine id, invalid_host if it does not parse
+    DICT = 3,   // dictionary-encoded name, for low-cardinality names
+    STRING = 4  // plain string, for names that hardly ever repeat
+};
+
+struct ColumnSpec {
+    std::string name;
+    ColumnType type;
+    int csv_column;
+};
+
+/* Columns kept from each of the CSV traces the converters read */
+std::vector<ColumnSpec> getColumnarSchema(const std::string& schema_name, int& num_csv_columns);
+
+struct ColumnarRowGroup {
+    uint64_t begin;
+    uint64_t end;
+};
+
+class ColumnarTrace {
+
+    public:
+        explicit ColumnarTrace(const std::string& file_path);
+
+        int findColumn(std::string_view name) const;
+        ColumnType getColumnType(int column) const;
+        uint64_t getNumRows() const { return this->header->num_rows; }
+        uint64_t getNumRowGroups() const { return this->header->num_row_groups; }
+        ColumnarRowGroup getRowGroup(uint64_t group) const;
+        double getMin(uint64_t group, int column) const;
+        double getMax(uint64_t group, int column) const;
+
+        const double* getDoubles(int column) const;
+        const int64_t* getLongs(int column) const;
+        const uint32_t* getIds(int column) const;
+        std::string_view getName(int column, uint32_t id) const;
+        std::string_view getString(int column, uint64_t row) const;
+
+        struct FileHeader {
+            char magic[8];
+            uint32_t num_columns;
+            uint32_t rows_per_group;
+            uint64_t num_rows;
+            uint64_t num_row_groups;
+            uint64_t zone_map_offset;
+        };
+
+        struct ColumnHeader {
+            char name[24];
+            ColumnType type;
+            uint32_t reserved;
+            uint64_t data_offset;
+            uint64_t dictionary_offset; // dictionary (DICT) or string bytes (STRING)
+        };
+
+        static const char magic[8];
+        static const int64_t invalid_host = INT64_MIN;
+
+    private:
+        const ColumnHeader& getColumnHeader(int column, ColumnType type) const;
+        const char* at(uint64_t offset) const { return this->file.begin() + offset; }
+
+        MappedFile file;
+        std::string file_path;
+        const FileHeader* header;
+        const ColumnHeader* columns;
+};
+
+/* Builds a columnar trace from CSV rows. Column data goes to temporary files
+ * next to the output while rows are added, and is stitched together by close(). */
+class ColumnarTraceWriter {
+
+    public:
+        ColumnarTraceWriter(const std::string& file_path, const std::vector<ColumnSpec>& schema, uint32_t rows_per_group = 1 << 16);
+        ~ColumnarTraceWriter();
+        ColumnarTraceWriter(const ColumnarTraceWriter&) = delete;
+        ColumnarTraceWriter& operator=(const ColumnarTraceWriter&) = delete;
+
+        void addRow(const std::string_view* fields);
+        void close();
+        uint64_t getNumRows() const { return this->num_rows; }
+
+    private:
+        struct Column {
+            ColumnSpec spec;
+            FILE* data = nullptr;
+            FILE* strings = nullptr;
+            uint64_t string_size = 0;
+            StringInterner dictionary;
+        };
+
+        void closeRowGroup();
+
+        std::string file_path;
+        std::vector<Column> columns;
+        uint32_t rows_per_group;
+        uint64_t num_rows = 0;
+        std::vector<double> group_min;
+        std::vector<double> group_max;
+        std::vector<double> zone_map;
+};
+
+#endif // TRACE_TO_WORKFLOWS_COLUMNARTRACE_H
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <future>
+#include <queue>
+#include <stdexcept>
+
+#include "ContainerSorter.h"
+
+ContainerSorter::ContainerSorter(const std::string& run_prefix, size_t memory_budget, int num_threads) {
+    this->run_prefix = run_prefix;
+    this->max_buffered = std::max<size_t>(1024, memory_budget / sizeof(ContainerRecord));
+    this->num_threads = std::max(1, num_threads);
+}
+
+ContainerSorter::~ContainerSorter() {
+    for (size_t i = 0; i < this->runs.size(); i++) {
+	fclose(this->runs[i]);
+	remove((this->run_prefix + std::to_string(i) + ".tmp").c_str());
+    }
+}
+
+void ContainerSorter::add(const ContainerRecord& record) {
+    this->buffer.push_back(record);
+    if (this->buffer.size() >= this->max_buffered) {
+	this->spill();
+    }
+}
+
+/* Sort one chunk per thread, then merge neighbouring chunks in rounds */
+void ContainerSorter::sortBuffer() {
+    size_t chunk = (this->buffer.size() + this->num_threads - 1) / this->num_threads;
+    if (this->num_threads == 1 || chunk < 4096) {
+	std::sort(this->buffer.begin(), this->buffer.end());
+	return;
+    }
+
+    std::vector<size_t> bounds;
+    for (size_t b = 0; b < this->buffer.size(); b += chunk) bounds.push_back(b);
+    bounds.push_back(this->buffer.size());
+
+    auto begin = this->buffer.begin();
+    std::vector<std::future<void>> workers;
+    for (size_t i = 0; i + 1 < bounds.size(); i++) {
+	workers.push_back(std::async(std::launch::async, [=]() { std::sort(begin + bounds[i], begin + bounds[i + 1]); }));
+    }
+    for (auto& worker : workers) worker.get();
+
+    while (bounds.size() > 2) {
+	std::vector<size_t> merged;
+	workers.clear();
+	for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+	    merged.push_back(bounds[i]);
+	    if (i + 2 < bounds.size()) {
+		workers.push_back(std::async(std::launch::async, [=]() {
+		    std::inplace_merge(begin + bounds[i], begin + bounds[i + 1], begin + bounds[i + 2]);
+		}));
+	    }
+	}
+	merged.push_back(bounds.back());
+	for (auto& worker : workers) worker.get();
+	bounds = merged;
+    }
+}
+
+void ContainerSorter::spill() {
+    if (this->buffer.empty()) return;
+    this->sortBuffer();
+
+    std::string run_path = this->run_prefix + std::to_string(this->runs.size()) + ".tmp";
+    FILE* run = fopen(run_path.c_str(), "w+");
+    if (run == nullptr) {
+	throw std::invalid_argument("Cannot open sort run " + run_path);
+    }
+    this->runs.push_back(run);
+    if (fwrite(this->buffer.data(), sizeof(ContainerRecord), this->buffer.size(), run) != this->buffer.size()) {
+	throw std::invalid_argument("Cannot write sort run " + run_path);
+    }
+    fflush(run);
+    this->buffer.clear();
+}
+
+/* Visit all records in order. Without spilled runs this is an in-memory sort,
+ * otherwise the last buffer is spilled too and all runs are merged. */
+void ContainerSorter::forEachSorted(std::function<void(const ContainerRecord&)> visit) {
+    if (this->runs.empty()) {
+	this->sortBuffer();
+	for (auto& record : this->buffer) visit(record);
+	return;
+    }
+    this->spill();
+    std::vector<ContainerRecord>().swap(this->buffer);
+
+    /* Each run is read through its own block buffer */
+    const size_t block_records = std::max<size_t>(1, this->max_buffered / (2 * this->runs.size()));
+    std::vector<std::vector<ContainerRecord>> blocks(this->runs.size());
+    std::vector<size_t> positions(this->runs.size(), 0);
+    auto refill = [&](size_t run) {
+	blocks[run].resize(block_records);
+	blocks[run].resize(fread(blocks[run].data(), sizeof(ContainerRecord), block_records, this->runs[run]));
+	positions[run] = 0;
+	return not blocks[run].empty();
+    };
+
+    auto greater = [&](size_t a, size_t b) { return blocks[b][positions[b]] < blocks[a][positions[a]]; };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heads(greater);
+    for (size_t run = 0; run < this->runs.size(); run++) {
+	rewind(this->runs[run]);
+	if (refill(run)) heads.push(run);
+    }
+
+    while (not heads.empty()) {
+	size_t run = heads.top();
+	heads.pop();
+	visit(blocks[run][positions[run]]);
+	if (++positions[run] < blocks[run].size() || refill(run)) {
+	    heads.push(run);
+	}
+    }
+}
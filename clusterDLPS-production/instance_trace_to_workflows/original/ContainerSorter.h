@@ -0,0 +1,61 @@
+#ifndef TRACE_TO_WORKFLOWS_CONTAINERSORTER_H
+#define TRACE_TO_WORKFLOWS_CONTAINERSORTER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/* One SWF job of the container trace, packed into 48 bytes. The window is
+ * the hour bucket of a per-window SWF file, and 0 for the single trace file
+ * (-1 when it is written along with the windows, see trace2swf --whole). */
+struct ContainerRecord {
+    int64_t start_time;
+    int64_t wait_time;
+    int64_t run_time;
+    int64_t avg_cpu;
+    int64_t max_cpu;
+    int32_t host_id;
+    int32_t window;
+};
+
+static_assert(sizeof(ContainerRecord) == 48, "ContainerRecord must stay packed");
+
+/* SWF order: window, start time, then host, requested and average processors, and run time */
+inline bool operator<(const ContainerRecord& a, const ContainerRecord& b) {
+    if (a.window != b.window) return a.window < b.window;
+    if (a.start_time != b.start_time) return a.start_time < b.start_time;
+    if (a.host_id != b.host_id) return a.host_id < b.host_id;
+    if (a.max_cpu != b.max_cpu) return a.max_cpu < b.max_cpu;
+    if (a.avg_cpu != b.avg_cpu) return a.avg_cpu < b.avg_cpu;
+    return a.run_time < b.run_time;
+}
+
+/* External merge sort of container records. Records are buffered up to a
+ * memory budget; a full buffer is sorted by several threads and spilled to a
+ * temporary run file, and the runs are merged while the output is written. */
+class ContainerSorter {
+
+    public:
+        ContainerSorter(const std::string& run_prefix, size_t memory_budget, int num_threads);
+        ~ContainerSorter();
+        ContainerSorter(const ContainerSorter&) = delete;
+        ContainerSorter& operator=(const ContainerSorter&) = delete;
+
+        void add(const ContainerRecord& record);
+        void forEachSorted(std::function<void(const ContainerRecord&)> visit);
+        int getNumRuns() const { return this->runs.size(); }
+
+    private:
+        void sortBuffer();
+        void spill();
+
+        std::string run_prefix;
+        size_t max_buffered;
+        int num_threads;
+        std::vector<ContainerRecord> buffer;
+        std::vector<FILE*> runs;
+};
+
+#endif // TRACE_TO_WORKFLOWS_CONTAINERSORTER_H
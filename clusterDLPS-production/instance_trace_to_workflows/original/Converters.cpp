@@ -0,0 +1,32 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+#include "Converters.h"
+
+void printConverterStats(const ConverterStats& stats) {
+    double seconds = std::max(stats.seconds, 1e-9);
+    std::cerr << std::left << std::setw(12) << stats.stage + ":" << std::right
+	      << std::setw(12) << stats.rows_read << " rows in " << std::fixed << std::setprecision(1) << std::setw(8) << stats.seconds << " s, "
+	      << std::setw(12) << std::setprecision(0) << stats.rows_read / seconds << " rows/s, "
+	      << std::setw(10) << std::setprecision(1) << stats.bytes_written / 1048576.0 << " MB written"
+	      << std::defaultfloat << std::setprecision(6) << std::endl;
+}
+
+void printConverterProgress(const std::string& stage, const std::string& progress, bool done) {
+    static std::mutex progress_mutex;
+    static std::map<std::string, std::string> progress_lines;
+
+    std::lock_guard<std::mutex> lock(progress_mutex);
+    progress_lines[stage] = progress;
+    std::cerr << "\r";
+    for (auto& line : progress_lines) {
+	std::cerr << "[" << line.first << "] " << line.second << "  ";
+    }
+    if (done) {
+	std::cerr << std::endl;
+	progress_lines.erase(stage);
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef TRACE_TO_WORKFLOWS_CONVERTERS_H
+#define TRACE_TO_WORKFLOWS_CONVERTERS_H
+
+#include <cstdint>
+#include <string>
+
+#include "MachineMap.h"
+
+/* What one conversion read and wrote */
+struct ConverterStats {
+    std::string stage;
+    long rows_read = 0;
+    uint64_t bytes_written = 0;
+    double seconds = 0;
+};
+
+void printConverterStats(const ConverterStats& stats);
+
+/* Rewrite the progress line of a conversion. Conversions running at once
+ * share the line, each under its own prefix; a done one is left above it. */
+void printConverterProgress(const std::string& stage, const std::string& progress, bool done = false);
+
+/* Command line of trace2workflows */
+struct WorkflowOptions {
+    int start_time_offset = 0;
+    int trace_duration = 0;
+    int dump_interval = 0;
+    int num_threads = 1;
+    long shard_size = 16L << 20;
+    double fp_rate = 0.001;
+    long expected_jobs = 8000000;
+    bool compact = false;
+    int num_writers = 1;
+    std::string columnar_path;
+    std::string checkpoint_path;
+    double checkpoint_interval = 600;
+    bool resume = false;
+    bool legacy_jitter = false;
+};
+
+/* Command line of trace2swf */
+struct SWFOptions {
+    std::string columnar_path;
+    int num_threads = 1;
+    long memory_budget = 1024L << 20;
+    bool windowed = false;
+    long window_offset = 0;
+    int num_windows = 0;
+    bool whole_trace = false; // with windows, also write container_trace.swf in the same pass
+};
+
+/* The conversions behind trace2workflows and trace2swf. The command line of
+ * each executable is parsed first, printing the usage and returning false
+ * when it is wrong, so that trace2all can check both before it runs them at
+ * once with a machine map shared between them. */
+bool parseWorkflowOptions(int argc, char **argv, WorkflowOptions& options);
+bool parseSWFOptions(int argc, char **argv, SWFOptions& options);
+int convertWorkflows(const WorkflowOptions& options, MachineMap& machines, ConverterStats& stats);
+int convertSWF(const SWFOptions& options, MachineMap& machines, ConverterStats& stats);
+
+#endif // TRACE_TO_WORKFLOWS_CONVERTERS_H
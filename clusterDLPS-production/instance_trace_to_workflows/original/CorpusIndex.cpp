@@ -0,0 +1,69 @@
+#include <charconv>
+#include <stdexcept>
+
+#include "CorpusIndex.h"
+
+const char* CorpusIndex::file_name = "corpus.idx";
+
+CorpusIndex::~CorpusIndex() {
+    for (auto& it : this->files) {
+	fclose(it.second);
+    }
+}
+
+void CorpusIndex::add(const std::string& directory, const CorpusEntry& entry) {
+    char line[512];
+    char* end = line + sizeof(line);
+    char* position = line;
+    auto field = [&](auto value) {
+	auto result = std::to_chars(position, end, value);
+	if (result.ec != std::errc()) {
+	    throw std::invalid_argument("Cannot format corpus entry of " + entry.file_name);
+	}
+	position = result.ptr;
+	if (position < end) *position++ = '\t';
+    };
+    field(entry.submitted_time);
+    field(entry.num_tasks);
+    field(entry.total_runtime);
+    field(entry.num_bytes);
+    position[-1] = '\n';
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    FILE*& file = this->files[directory];
+    if (file == nullptr) {
+	std::string path = directory + (directory.empty() or directory.back() == '/' ? "" : "/") + file_name;
+	file = fopen(path.c_str(), this->append ? "a" : "w");
+	if (file == nullptr) {
+	    this->files.erase(directory);
+	    throw std::invalid_argument("Cannot open file for output!");
+	}
+	if (not this->append) {
+	    fputs("# name\texecutedAt\ttasks\truntime\tbytes\n", file);
+	}
+    }
+    if (fprintf(file, "%s\t%.*s", entry.file_name.c_str(), (int) (position - line), line) < 0) {
+	throw std::invalid_argument("Cannot write file for output!");
+    }
+}
+
+void CorpusIndex::flush() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (auto& it : this->files) {
+	if (fflush(it.second) != 0) {
+	    throw std::invalid_argument("Cannot write file for output!");
+	}
+    }
+}
+
+void CorpusIndex::close() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    bool failed = false;
+    for (auto& it : this->files) {
+	failed = fclose(it.second) != 0 or failed;
+    }
+    this->files.clear();
+    if (failed) {
+	throw std::invalid_argument("Cannot write file for output!");
+    }
+}
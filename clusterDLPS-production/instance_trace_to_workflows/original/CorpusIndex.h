@@ -0,0 +1,44 @@
+#ifndef TRACE_TO_WORKFLOWS_CORPUSINDEX_H
+#define TRACE_TO_WORKFLOWS_CORPUSINDEX_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+
+/* One workflow file of a corpus */
+struct CorpusEntry {
+    std::string file_name; // relative to the directory of the index
+    double submitted_time;  // executedAt
+    long num_tasks;
+    double total_runtime;   // sum of the task runtimes
+    uint64_t num_bytes;     // size of the workflow file
+};
+
+/* corpus.idx files next to the workflow files, one per output directory. Each
+ * line holds an entry as tab-separated text, numbers in shortest round-trip form;
+ * lines starting with '#' are comments. Entries can be added from any thread.
+ * When appending (after a resume) a file may list a workflow twice, and readers
+ * keep the last entry. */
+class CorpusIndex {
+
+    public:
+        explicit CorpusIndex(bool append = false) : append(append) {}
+        ~CorpusIndex();
+        CorpusIndex(const CorpusIndex&) = delete;
+        CorpusIndex& operator=(const CorpusIndex&) = delete;
+
+        void add(const std::string& directory, const CorpusEntry& entry);
+        void flush();
+        void close();
+
+        static const char* file_name;
+
+    private:
+        std::mutex mutex;
+        std::map<std::string, FILE*> files;
+        bool append;
+};
+
+#endif // TRACE_TO_WORKFLOWS_CORPUSINDEX_H
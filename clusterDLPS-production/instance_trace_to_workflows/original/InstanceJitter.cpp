@@ -0,0 +1,19 @@
+#include <random>
+
+#include "InstanceJitter.h"
+
+void jitterTimes(const uint64_t* name_hashes, double* start_times, double* end_times, size_t num_rows) {
+    for (size_t i = 0; i < num_rows; i++) {
+	jitterTimes(name_hashes[i], start_times[i], end_times[i]);
+    }
+}
+
+void jitterTimesLegacy(std::string_view instance_name, double& start_time, double& end_time) {
+    std::mt19937 rng;
+    std::seed_seq seed(instance_name.begin(), instance_name.end());
+    rng.seed(seed);
+    std::uniform_real_distribution<double> dist1(end_time, end_time + 1);
+    end_time = std::max(dist1(rng), 0.0);
+    std::uniform_real_distribution<double> dist2(start_time, std::min(start_time + 1, end_time));
+    start_time = std::max(dist2(rng), 0.0);
+}
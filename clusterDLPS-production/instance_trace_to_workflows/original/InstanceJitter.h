@@ -0,0 +1,38 @@
+#ifndef TRACE_TO_WORKFLOWS_INSTANCEJITTER_H
+#define TRACE_TO_WORKFLOWS_INSTANCEJITTER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/* Instance start and end times of the trace are whole seconds. Both converters
+ * move them by up to a second to break ties: the end time by U1 in [0, 1), then
+ * the start time by U2 of the way towards min(start + 1, end), both kept >= 0.
+ *
+ * U1 and U2 are the SplitMix64 outputs for counters 1 and 2 of a 64-bit hash of
+ * the instance name, so they depend on nothing but the name. The legacy variant
+ * draws them from a Mersenne Twister seeded with the name instead, and gives the
+ * values of workflows converted before. */
+inline uint64_t splitMix64(uint64_t state, uint64_t counter) {
+    uint64_t z = state + counter * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+inline void jitterTimes(uint64_t name_hash, double& start_time, double& end_time) {
+    double u1 = (splitMix64(name_hash, 1) >> 11) * 0x1.0p-53;
+    double u2 = (splitMix64(name_hash, 2) >> 11) * 0x1.0p-53;
+    end_time = std::max(end_time + u1, 0.0);
+    start_time = std::max(start_time + u2 * (std::min(start_time + 1, end_time) - start_time), 0.0);
+}
+
+/* The same over a batch of rows whose name hashes are computed beforehand. On baseline
+ * x86-64 the loop stays scalar (no vector 64-bit multiply); it only vectorizes with
+ * AVX-512DQ or similar. */
+void jitterTimes(const uint64_t* name_hashes, double* start_times, double* end_times, size_t num_rows);
+
+void jitterTimesLegacy(std::string_view instance_name, double& start_time, double& end_time);
+
+#endif // TRACE_TO_WORKFLOWS_INSTANCEJITTER_H
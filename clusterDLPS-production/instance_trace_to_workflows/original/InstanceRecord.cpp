@@ -0,0 +1,99 @@
+#include <vector>
+#include <string>
+
+#include "helper/helper.h"
+#include "InstanceRecord.h"
+
+/* Read the next row of batch_instance.csv. Only the numbers the converter uses are parsed.
+ * With a filter, start_time and machine_id are looked at first and a row outside of the
+ * window or the machine range is not split any further. */
+bool readInstanceRow(MappedCSVReader& reader, InstanceRecord& r, const InstanceFilter* filter) {
+    const int num_instance_column = 14;
+    std::string_view fields[num_instance_column];
+    std::string_view line;
+    if (not reader.readLine(line)) return false;
+
+    r.filtered = false;
+    if (filter and MappedCSVReader::splitPrefix(line, fields, 8) == 8) {
+	double start_time;
+	MappedCSVReader::parse(fields[5], start_time);
+	if (not filter->inTimeRange(start_time) or parseHostId(fields[7]) >= filter->num_hosts) {
+	    r.job_name = fields[2];
+	    r.in_range = false;
+	    r.filtered = true;
+	    return true;
+	}
+    }
+    reader.splitRow(line, fields, num_instance_column);
+
+    r.instance_name = fields[0];
+    r.task_name = fields[1];
+    r.job_name = fields[2];
+    r.status = fields[4];
+    MappedCSVReader::parse(fields[5], r.start_time);
+    MappedCSVReader::parse(fields[6], r.end_time);
+    r.machine_id = fields[7];
+    MappedCSVReader::parse(fields[8], r.sequence_number);
+    MappedCSVReader::parse(fields[10], r.avg_cpu);
+    MappedCSVReader::parse(fields[12], r.avg_mem);
+    r.host_parsed = false;
+
+    return true;
+}
+
+InstanceColumns::InstanceColumns(const ColumnarTrace& trace) : trace(trace) {
+    this->instance_name = trace.findColumn("instance_name");
+    this->task_name = trace.findColumn("task_name");
+    this->job_name = trace.findColumn("job_name");
+    this->status = trace.findColumn("status");
+    this->start_time = trace.findColumn("start_time");
+    this->end_time = trace.findColumn("end_time");
+    this->host_id = trace.findColumn("host_id");
+    this->sequence_number = trace.findColumn("seq_no");
+    this->avg_cpu = trace.findColumn("cpu_avg");
+    this->avg_mem = trace.findColumn("mem_avg");
+}
+
+/* A row group whose zone map lies entirely outside of the window or the machine range
+ * (an unparsable machine id keeps the minimum host below any range) */
+bool isRowGroupFiltered(const InstanceColumns& columns, uint64_t group, const InstanceFilter& filter) {
+    const ColumnarTrace& trace = columns.trace;
+    return trace.getMax(group, columns.start_time) <= filter.start_time_begin
+	or trace.getMin(group, columns.start_time) > filter.start_time_end
+	or trace.getMin(group, columns.host_id) >= filter.num_hosts;
+}
+
+/* A row rejected without reading it: only its job is needed */
+void readFilteredRow(const InstanceColumns& columns, uint64_t row, InstanceRecord& r) {
+    r.job_name = columns.trace.getName(columns.job_name, columns.trace.getIds(columns.job_name)[row]);
+    r.in_range = false;
+    r.filtered = true;
+}
+
+/* Fill a record from one row of a columnar trace. Names are views into the mapping. */
+void readInstanceRow(const InstanceColumns& columns, uint64_t row, InstanceRecord& r, const InstanceFilter* filter) {
+    const ColumnarTrace& trace = columns.trace;
+    if (filter) {
+	double start_time = trace.getDoubles(columns.start_time)[row];
+	int64_t host_id = trace.getLongs(columns.host_id)[row];
+	if (not filter->inTimeRange(start_time) or (host_id != ColumnarTrace::invalid_host and host_id >= filter->num_hosts)) {
+	    readFilteredRow(columns, row, r);
+	    return;
+	}
+    }
+    r.filtered = false;
+    r.instance_name = trace.getString(columns.instance_name, row);
+    r.task_name = trace.getString(columns.task_name, row);
+    r.job_name = trace.getString(columns.job_name, row);
+    r.status = trace.getString(columns.status, row);
+    r.start_time = trace.getDoubles(columns.start_time)[row];
+    r.end_time = trace.getDoubles(columns.end_time)[row];
+    r.sequence_number = trace.getLongs(columns.sequence_number)[row];
+    r.avg_cpu = trace.getDoubles(columns.avg_cpu)[row];
+    r.avg_mem = trace.getDoubles(columns.avg_mem)[row];
+
+    /* An unparsable machine id is left to the preparation step, which rejects it as the CSV path would */
+    r.host_id = trace.getLongs(columns.host_id)[row];
+    r.host_parsed = r.host_id != ColumnarTrace::invalid_host;
+    r.machine_id = std::string_view();
+}
@@ -0,0 +1,57 @@
+#ifndef TRACE_TO_WORKFLOWS_INSTANCERECORD_H
+#define TRACE_TO_WORKFLOWS_INSTANCERECORD_H
+
+#include <string>
+#include <string_view>
+
+#include "MappedCSVReader.h"
+#include "ColumnarTrace.h"
+
+/* One row of batch_instance.csv, with the columns the converter keeps.
+ * Name fields are views into the mapped trace file. */
+struct InstanceRecord {
+    std::string_view instance_name;
+    std::string_view task_name;
+    std::string_view job_name;
+    std::string_view status;
+    std::string_view machine_id;
+    double start_time = 0;
+    double end_time = 0;
+    long sequence_number = 0;
+    double avg_cpu = 0;
+    double avg_mem = 0;
+
+    /* Filled in by the stateless preparation step, unless the trace has parsed machine ids already */
+    std::string instance_id;
+    long host_id = -1;
+    bool host_parsed = false;
+    bool in_range = false;
+    bool filtered = false; // rejected before it was read, only job_name is set
+};
+
+/* Time window and machine range of a conversion, checked on the raw start_time
+ * and machine_id of a row (or on the zone map of a row group) before the rest
+ * of it is read. A row outside of them only rejects its job. */
+struct InstanceFilter {
+    double start_time_begin; // exclusive
+    double start_time_end;   // inclusive
+    long num_hosts;
+
+    bool inTimeRange(double start_time) const { return start_time > this->start_time_begin && start_time <= this->start_time_end; }
+};
+
+bool readInstanceRow(MappedCSVReader& reader, InstanceRecord& r, const InstanceFilter* filter = nullptr);
+
+/* Columns of a columnar batch_instance trace, looked up once */
+struct InstanceColumns {
+    explicit InstanceColumns(const ColumnarTrace& trace);
+
+    const ColumnarTrace& trace;
+    int instance_name, task_name, job_name, status, start_time, end_time, host_id, sequence_number, avg_cpu, avg_mem;
+};
+
+void readInstanceRow(const InstanceColumns& columns, uint64_t row, InstanceRecord& r, const InstanceFilter* filter = nullptr);
+bool isRowGroupFiltered(const InstanceColumns& columns, uint64_t group, const InstanceFilter& filter);
+void readFilteredRow(const InstanceColumns& columns, uint64_t row, InstanceRecord& r);
+
+#endif // TRACE_TO_WORKFLOWS_INSTANCERECORD_H
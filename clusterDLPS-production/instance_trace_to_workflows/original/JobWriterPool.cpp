@@ -0,0 +1,74 @@
+#include <chrono>
+
+#include "AlibabaJob.h"
+#include "JobWriterPool.h"
+
+JobWriterPool::JobWriterPool(int num_writers, size_t capacity, std::function<int(AlibabaJob*)> write)
+	: queue(capacity), write(write) {
+    for (int i = 0; i < num_writers; i++) {
+	this->writers.emplace_back(&JobWriterPool::run, this);
+    }
+}
+
+JobWriterPool::~JobWriterPool() {
+    this->done = true;
+    for (auto& writer : this->writers) {
+	if (writer.joinable()) writer.join();
+    }
+}
+
+void JobWriterPool::submit(AlibabaJob* job) {
+    if (this->writers.empty()) {
+	this->num_written += this->write(job);
+	delete job;
+	return;
+    }
+    while (not this->queue.tryPush(job)) { // backpressure
+	std::this_thread::yield();
+    }
+    this->num_submitted++;
+}
+
+/* Wait until every submitted job has been written, e.g. before a checkpoint */
+void JobWriterPool::drain() {
+    while (this->num_processed.load(std::memory_order_acquire) < this->num_submitted) {
+	std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    std::lock_guard<std::mutex> lock(this->error_mutex);
+    if (this->error) {
+	std::rethrow_exception(this->error);
+    }
+}
+
+void JobWriterPool::run() {
+    AlibabaJob* job;
+    while (true) {
+	if (not this->queue.tryPop(job)) {
+	    bool finishing = this->done;
+	    if (not this->queue.tryPop(job)) { // look again, a push may have landed before done was set
+		if (finishing) return;
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+		continue;
+	    }
+	}
+	try {
+	    this->num_written += this->write(job);
+	} catch (...) {
+	    std::lock_guard<std::mutex> lock(this->error_mutex);
+	    if (not this->error) this->error = std::current_exception();
+	}
+	delete job;
+	this->num_processed.fetch_add(1, std::memory_order_release);
+    }
+}
+
+/* Write out everything still queued, stop the writers and rethrow the first error of any of them */
+void JobWriterPool::finish() {
+    this->done = true;
+    for (auto& writer : this->writers) {
+	if (writer.joinable()) writer.join();
+    }
+    if (this->error) {
+	std::rethrow_exception(this->error);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef TRACE_TO_WORKFLOWS_JOBWRITERPOOL_H
+#define TRACE_TO_WORKFLOWS_JOBWRITERPOOL_H
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BoundedQueue.h"
+
+class AlibabaJob;
+
+/* Writer threads that take completed jobs off the parser thread, write them
+ * out and delete them. submit() blocks while the queue is full, which keeps
+ * the number of finished but unwritten jobs bounded. With no writer threads
+ * jobs are written inline by submit(). */
+class JobWriterPool {
+
+    public:
+        JobWriterPool(int num_writers, size_t capacity, std::function<int(AlibabaJob*)> write);
+        ~JobWriterPool();
+
+        void submit(AlibabaJob* job);
+        void drain();
+        void finish();
+        long getNumWritten() const { return this->num_written.load(std::memory_order_relaxed); }
+        void setNumWritten(long num_written) { this->num_written = num_written; }
+
+    private:
+        void run();
+
+        BoundedQueue<AlibabaJob*> queue;
+        std::function<int(AlibabaJob*)> write;
+        std::vector<std::thread> writers;
+        std::atomic<bool> done{false};
+        std::atomic<long> num_written{0};
+        long num_submitted = 0;
+        std::atomic<long> num_processed{0};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+};
+
+#endif // TRACE_TO_WORKFLOWS_JOBWRITERPOOL_H
@@ -0,0 +1,55 @@
+#include <atomic>
+#include <vector>
+#include <string>
+
+#include "helper/helper.h"
+#include "MachineMap.h"
+
+static std::atomic<uint64_t> num_machine_maps{0};
+
+MachineMap::MachineMap() {
+    this->generation = ++num_machine_maps;
+}
+
+long MachineMap::getHostId(std::string_view machine_id) {
+    struct Cache {
+	uint64_t generation = 0;
+	StringInterner machine_ids;
+	std::vector<long> host_ids;
+    };
+    thread_local Cache cache;
+
+    if (cache.generation != this->generation) {
+	cache = Cache();
+	cache.generation = this->generation;
+    }
+
+    uint32_t id;
+    if (cache.machine_ids.lookup(machine_id, id)) {
+	return cache.host_ids[id];
+    }
+
+    long host_id;
+    {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	id = this->machine_ids.intern(machine_id);
+	if (id == this->host_ids.size()) {
+	    try {
+		this->host_ids.push_back(parseHostId(machine_id));
+	    } catch (...) {
+		this->machine_ids.release(id);
+		throw;
+	    }
+	}
+	host_id = this->host_ids[id];
+    }
+
+    cache.machine_ids.intern(machine_id);
+    cache.host_ids.push_back(host_id);
+    return host_id;
+}
+
+size_t MachineMap::size() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->machine_ids.size();
+}
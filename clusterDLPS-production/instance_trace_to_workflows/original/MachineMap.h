@@ -0,0 +1,30 @@
+#ifndef TRACE_TO_WORKFLOWS_MACHINEMAP_H
+#define TRACE_TO_WORKFLOWS_MACHINEMAP_H
+
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "StringInterner.h"
+
+/* Static host ids of machine ids ("m_1932" -> 1931), shared by the converters
+ * of one run so that both traces map a machine to the same host. Machine ids
+ * are interned once in a table behind a lock; every thread keeps a copy of the
+ * ids it has looked up, so a machine only takes the lock once per thread. */
+class MachineMap {
+
+    public:
+        MachineMap();
+
+        long getHostId(std::string_view machine_id);
+        size_t size() const;
+
+    private:
+        mutable std::mutex mutex;
+        StringInterner machine_ids;
+        std::vector<long> host_ids;
+        uint64_t generation; // tells thread caches of different maps apart
+};
+
+#endif // TRACE_TO_WORKFLOWS_MACHINEMAP_H
@@ -0,0 +1,133 @@
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "MappedCSVReader.h"
+
+MappedFile::MappedFile(const std::string& file_path) {
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+	throw std::invalid_argument("Cannot open file " + file_path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+	close(fd);
+	throw std::invalid_argument("Cannot stat file " + file_path);
+    }
+    this->size = st.st_size;
+
+    if (this->size > 0) {
+	void* mapping = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mapping == MAP_FAILED) {
+	    close(fd);
+	    throw std::runtime_error("Cannot map file " + file_path);
+	}
+	madvise(mapping, this->size, MADV_SEQUENTIAL);
+	this->data = static_cast<const char*>(mapping);
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (this->data) {
+	munmap(const_cast<char*>(this->data), this->size);
+    }
+}
+
+MappedCSVReader::MappedCSVReader(const char* begin, const char* end, const std::string& file_name) {
+    this->position = begin;
+    this->end = end;
+    this->file_name = file_name;
+}
+
+static std::string_view trim(const char* begin, const char* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+    return std::string_view(begin, end - begin);
+}
+
+/* Find the next non-empty line. Returns false at the end of the range. */
+bool MappedCSVReader::readLine(std::string_view& line) {
+    const char* line_end = nullptr;
+    do {
+	if (this->position >= this->end) return false;
+	line_end = static_cast<const char*>(memchr(this->position, '\n', this->end - this->position));
+	if (not line_end) line_end = this->end;
+	this->line_number++;
+	if (trim(this->position, line_end).empty()) {
+	    this->position = line_end < this->end ? line_end + 1 : this->end;
+	    line_end = nullptr;
+	}
+    } while (not line_end);
+
+    line = std::string_view(this->position, line_end - this->position);
+    this->position = line_end < this->end ? line_end + 1 : this->end;
+    return true;
+}
+
+/* Split the first num_fields fields of a line, without looking at the rest of it.
+ * Returns how many were found, which is less than num_fields on a short line. */
+int MappedCSVReader::splitPrefix(std::string_view line, std::string_view* fields, int num_fields) {
+    const char* field_begin = line.data();
+    const char* line_end = line.data() + line.size();
+    int idx_field = 0;
+    for (const char* c = line.data(); c <= line_end && idx_field < num_fields; c++) {
+	if (c == line_end || *c == ',') {
+	    fields[idx_field++] = trim(field_begin, c);
+	    field_begin = c + 1;
+	}
+    }
+    return idx_field;
+}
+
+/* Split a line read by readLine() into exactly num_fields views */
+void MappedCSVReader::splitRow(std::string_view line, std::string_view* fields, int num_fields) {
+    const char* field_begin = line.data();
+    const char* line_end = line.data() + line.size();
+    int idx_field = 0;
+    for (const char* c = line.data(); c <= line_end; c++) {
+	if (c == line_end || *c == ',') {
+	    if (idx_field == num_fields) {
+		throw std::runtime_error("Too many columns in line " + std::to_string(this->line_number) + " of " + this->file_name);
+	    }
+	    fields[idx_field++] = trim(field_begin, c);
+	    field_begin = c + 1;
+	}
+    }
+    if (idx_field != num_fields) {
+	throw std::runtime_error("Too few columns in line " + std::to_string(this->line_number) + " of " + this->file_name);
+    }
+}
+
+/* Split the next non-empty line into exactly num_fields views. Returns false at the end of the range. */
+bool MappedCSVReader::readRow(std::string_view* fields, int num_fields) {
+    std::string_view line;
+    if (not this->readLine(line)) return false;
+    this->splitRow(line, fields, num_fields);
+    return true;
+}
+
+/* Numbers are parsed in place; an empty field reads as 0 like fast-cpp-csv-parser did */
+void MappedCSVReader::parse(std::string_view field, double& value) {
+    value = 0;
+    if (field.empty()) return;
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (result.ec != std::errc() || result.ptr != field.data() + field.size()) {
+	throw std::invalid_argument("Cannot parse \"" + std::string(field) + "\" as a number");
+    }
+}
+
+void MappedCSVReader::parse(std::string_view field, long& value) {
+    value = 0;
+    if (field.empty()) return;
+    if (field.front() == '+') field.remove_prefix(1);
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (result.ec != std::errc() || result.ptr != field.data() + field.size()) {
+	throw std::invalid_argument("Cannot parse \"" + std::string(field) + "\" as an integer");
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef TRACE_TO_WORKFLOWS_MAPPEDCSVREADER_H
+#define TRACE_TO_WORKFLOWS_MAPPEDCSVREADER_H
+
+#include <string>
+#include <string_view>
+
+/* Read-only memory mapping of a whole file */
+class MappedFile {
+
+    public:
+        explicit MappedFile(const std::string& file_path);
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* begin() const { return this->data; }
+        const char* end() const { return this->data + this->size; }
+        size_t getSize() const { return this->size; }
+
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+};
+
+/* Zero-copy CSV reader over a byte range of a mapped file. Fields are
+ * returned as views into the mapping, trimmed of blanks; quoting is not
+ * supported, as none of the Alibaba traces use it. */
+class MappedCSVReader {
+
+    public:
+        MappedCSVReader(const char* begin, const char* end, const std::string& file_name = "");
+        bool readRow(std::string_view* fields, int num_fields);
+        bool readLine(std::string_view& line);
+        void splitRow(std::string_view line, std::string_view* fields, int num_fields);
+        static int splitPrefix(std::string_view line, std::string_view* fields, int num_fields);
+        const char* getPosition() const { return this->position; }
+        long getLineNumber() const { return this->line_number; }
+
+        static void parse(std::string_view field, double& value);
+        static void parse(std::string_view field, long& value);
+
+    private:
+        const char* position;
+        const char* end;
+        std::string file_name;
+        long line_number = 0;
+};
+
+#endif // TRACE_TO_WORKFLOWS_MAPPEDCSVREADER_H
@@ -0,0 +1,64 @@
+#include <cmath>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "helper/helper.h"
+#include "CheckpointIO.h"
+#include "RejectedJobFilter.h"
+
+RejectedJobFilter::RejectedJobFilter(long expected_jobs, double false_positive_rate) {
+    expected_jobs = std::max(1L, expected_jobs);
+    false_positive_rate = std::min(std::max(false_positive_rate, 1e-12), 0.5);
+
+    double bits_per_job = -std::log(false_positive_rate) / (std::log(2) * std::log(2));
+    this->num_bits = std::max<uint64_t>(64, std::ceil(bits_per_job * expected_jobs));
+    this->num_hashes = std::max(1, (int) std::lround(bits_per_job * std::log(2)));
+    this->bits.assign((this->num_bits + 63) / 64, 0);
+}
+
+/* Double hashing: probe i is h1 + i * h2 */
+void RejectedJobFilter::insert(std::string_view job_name) {
+    uint64_t hash = hashString(job_name);
+    uint64_t h1 = hash & 0xffffffffULL;
+    uint64_t h2 = (hash >> 32) | 1;
+    for (int i = 0; i < this->num_hashes; i++) {
+	uint64_t bit = (h1 + i * h2) % this->num_bits;
+	this->bits[bit / 64] |= 1ULL << (bit % 64);
+    }
+    this->num_inserted++;
+}
+
+bool RejectedJobFilter::contains(std::string_view job_name) const {
+    uint64_t hash = hashString(job_name);
+    uint64_t h1 = hash & 0xffffffffULL;
+    uint64_t h2 = (hash >> 32) | 1;
+    for (int i = 0; i < this->num_hashes; i++) {
+	uint64_t bit = (h1 + i * h2) % this->num_bits;
+	if (not (this->bits[bit / 64] & (1ULL << (bit % 64)))) return false;
+    }
+    return true;
+}
+
+/* Expected false-positive rate for the number of jobs inserted so far */
+double RejectedJobFilter::getFalsePositiveRate() const {
+    return std::pow(1.0 - std::exp(-(double) this->num_hashes * this->num_inserted / this->num_bits), this->num_hashes);
+}
+
+void RejectedJobFilter::save(std::ostream& out) const {
+    writeBinary(out, this->num_bits);
+    writeBinary(out, this->num_hashes);
+    writeBinary(out, this->num_inserted);
+    out.write(reinterpret_cast<const char*>(this->bits.data()), this->bits.size() * sizeof(uint64_t));
+}
+
+/* Restore a saved filter, whatever size this one was built with */
+void RejectedJobFilter::load(std::istream& in) {
+    this->num_bits = readBinary<uint64_t>(in);
+    this->num_hashes = readBinary<int>(in);
+    this->num_inserted = readBinary<long>(in);
+    this->bits.assign((this->num_bits + 63) / 64, 0);
+    if (not in.read(reinterpret_cast<char*>(this->bits.data()), this->bits.size() * sizeof(uint64_t))) {
+	throw std::runtime_error("Truncated checkpoint");
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef TRACE_TO_WORKFLOWS_REJECTEDJOBFILTER_H
+#define TRACE_TO_WORKFLOWS_REJECTEDJOBFILTER_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <istream>
+#include <ostream>
+
+/* Bloom filter over the names of jobs that were rejected or already dumped.
+ * Its size is fixed up front from the expected number of jobs and the
+ * false-positive budget, so memory does not grow with the trace window.
+ * A false positive drops a job that should have been kept; jobs still in
+ * flight must be checked exactly before asking the filter. */
+class RejectedJobFilter {
+
+    public:
+        RejectedJobFilter(long expected_jobs, double false_positive_rate);
+        void insert(std::string_view job_name);
+        bool contains(std::string_view job_name) const;
+        long getNumInserted() const { return this->num_inserted; }
+        size_t getSizeInBytes() const { return this->bits.size() * sizeof(uint64_t); }
+        double getFalsePositiveRate() const;
+        void save(std::ostream& out) const;
+        void load(std::istream& in);
+
+    private:
+        std::vector<uint64_t> bits;
+        uint64_t num_bits;
+        int num_hashes;
+        long num_inserted = 0;
+};
+
+#endif // TRACE_TO_WORKFLOWS_REJECTEDJOBFILTER_H
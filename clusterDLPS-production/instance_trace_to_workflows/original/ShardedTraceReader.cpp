@@ -0,0 +1,60 @@
+#include <future>
+#include <cstring>
+#include <algorithm>
+
+#include "ShardedTraceReader.h"
+
+ShardedTraceReader::ShardedTraceReader(const MappedFile& trace, int num_threads, long shard_size,
+				       std::function<void(InstanceRecord&)> prepare, const InstanceFilter* filter) : trace(trace) {
+    this->num_threads = std::max(1, num_threads);
+    this->shard_size = std::max(1L, shard_size);
+    this->prepare = prepare;
+    this->filter = filter;
+    this->limit = trace.getSize();
+}
+
+/* Move a position forward to the first byte of the next line, or to the limit */
+long ShardedTraceReader::alignToLine(long position) {
+    long file_size = this->limit;
+    if (position <= 0) return 0;
+    if (position >= file_size) return file_size;
+
+    const char* line_end = static_cast<const char*>(
+	    memchr(this->trace.begin() + position - 1, '\n', file_size - position + 1));
+    return line_end ? line_end - this->trace.begin() + 1 : file_size;
+}
+
+void ShardedTraceReader::parseShard(long begin, long end, std::vector<InstanceRecord>& records) {
+    MappedCSVReader task_trace(this->trace.begin() + begin, this->trace.begin() + end);
+
+    InstanceRecord r;
+    while (readInstanceRow(task_trace, r, this->filter)) {
+	this->prepare(r);
+	records.push_back(r);
+    }
+}
+
+/* Parse the next (up to) num_threads shards concurrently. Returns false once the file, up to the limit, has been consumed. */
+bool ShardedTraceReader::readBatch(std::vector<std::vector<InstanceRecord>>& shards) {
+    shards.clear();
+    if (this->offset >= this->limit) return false;
+
+    std::vector<std::pair<long, long>> ranges;
+    while ((int) ranges.size() < this->num_threads && this->offset < this->limit) {
+	long end = this->alignToLine(std::min(this->offset + this->shard_size, this->limit));
+	ranges.push_back(std::make_pair(this->offset, end));
+	this->offset = end;
+    }
+
+    shards.resize(ranges.size());
+    std::vector<std::future<void>> workers;
+    for (size_t i = 0; i < ranges.size(); i++) {
+	workers.push_back(std::async(std::launch::async, &ShardedTraceReader::parseShard, this,
+				     ranges[i].first, ranges[i].second, std::ref(shards[i])));
+    }
+    for (auto& worker : workers) {
+	worker.get(); // rethrows parse errors of the shard
+    }
+
+    return true;
+}
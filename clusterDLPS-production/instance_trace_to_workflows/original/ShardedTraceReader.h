@@ -0,0 +1,40 @@
+#ifndef TRACE_TO_WORKFLOWS_SHARDEDTRACEREADER_H
+#define TRACE_TO_WORKFLOWS_SHARDEDTRACEREADER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+#include "MappedCSVReader.h"
+#include "InstanceRecord.h"
+
+/* Split the instance trace into byte ranges aligned to line boundaries and
+ * parse one batch of them at a time, one shard per worker thread. Shards of
+ * a batch are returned in file order so that the caller can replay them
+ * exactly as the serial reader would have seen them. */
+class ShardedTraceReader {
+
+    public:
+        ShardedTraceReader(const MappedFile& trace, int num_threads, long shard_size,
+			   std::function<void(InstanceRecord&)> prepare, const InstanceFilter* filter = nullptr);
+        bool readBatch(std::vector<std::vector<InstanceRecord>>& shards);
+        long getOffset() { return this->offset; }
+        void setOffset(long offset) { this->offset = this->alignToLine(offset); }
+        long getFileSize() { return this->trace.getSize(); }
+        void setLimit(long limit) { this->limit = std::min(this->alignToLine(limit), this->getFileSize()); }
+
+    private:
+        long alignToLine(long position);
+        void parseShard(long begin, long end, std::vector<InstanceRecord>& records);
+
+        const MappedFile& trace;
+        int num_threads;
+        long shard_size;
+        long offset = 0;
+        long limit;
+        std::function<void(InstanceRecord&)> prepare;
+        const InstanceFilter* filter;
+};
+
+#endif // TRACE_TO_WORKFLOWS_SHARDEDTRACEREADER_H
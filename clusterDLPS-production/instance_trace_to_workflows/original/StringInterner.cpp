@@ -0,0 +1,42 @@
+#include <stdexcept>
+
+#include "StringInterner.h"
+
+uint32_t StringInterner::intern(std::string_view name) {
+    auto it = this->ids.find(name);
+    if (it != this->ids.end()) {
+	return it->second;
+    }
+
+    if (not this->free_ids.empty()) {
+	uint32_t id = this->free_ids.back();
+	this->free_ids.pop_back();
+	this->names[id].assign(name);
+	this->ids.emplace(this->names[id], id);
+	return id;
+    }
+
+    if (this->names.size() == UINT32_MAX) {
+	throw std::overflow_error("Too many distinct names to intern");
+    }
+    uint32_t id = this->names.size();
+    this->names.emplace_back(name);
+    this->ids.emplace(this->names.back(), id);
+    return id;
+}
+
+bool StringInterner::lookup(std::string_view name, uint32_t& id) const {
+    auto it = this->ids.find(name);
+    if (it == this->ids.end()) {
+	return false;
+    }
+    id = it->second;
+    return true;
+}
+
+/* Forget a name and make its id available again */
+void StringInterner::release(uint32_t id) {
+    this->ids.erase(this->names[id]);
+    std::string().swap(this->names[id]);
+    this->free_ids.push_back(id);
+}
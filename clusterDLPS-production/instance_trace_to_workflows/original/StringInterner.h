@@ -0,0 +1,29 @@
+#ifndef TRACE_TO_WORKFLOWS_STRINGINTERNER_H
+#define TRACE_TO_WORKFLOWS_STRINGINTERNER_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/* Map names to dense 32-bit ids. Each distinct name is stored once; ids are
+ * handed out in first-seen order starting at 0, and ids given back with
+ * release() are reused before new ones. Not thread-safe. */
+class StringInterner {
+
+    public:
+        uint32_t intern(std::string_view name);
+        bool lookup(std::string_view name, uint32_t& id) const;
+        void release(uint32_t id);
+        const std::string& getName(uint32_t id) const { return this->names[id]; }
+        size_t size() const { return this->ids.size(); }
+
+    private:
+        std::deque<std::string> names; // stable addresses, the index keys view into them
+        std::unordered_map<std::string_view, uint32_t> ids;
+        std::vector<uint32_t> free_ids;
+};
+
+#endif // TRACE_TO_WORKFLOWS_STRINGINTERNER_H
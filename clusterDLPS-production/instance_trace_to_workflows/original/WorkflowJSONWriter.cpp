@@ -0,0 +1,184 @@
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "WorkflowJSONWriter.h"
+
+static const size_t buffer_size = 1 << 20;
+
+WorkflowJSONWriter::WorkflowJSONWriter(const std::string& file_path, bool compact) : compact(compact) {
+    this->file = fopen(file_path.c_str(), "w");
+    if (this->file == nullptr) {
+	throw std::invalid_argument("Cannot open file for output!");
+    }
+    this->buffer.reserve(buffer_size);
+}
+
+WorkflowJSONWriter::~WorkflowJSONWriter() {
+    if (this->file) {
+	fclose(this->file);
+    }
+}
+
+void WorkflowJSONWriter::flush() {
+    if (not this->buffer.empty() and fwrite(this->buffer.data(), 1, this->buffer.size(), this->file) != this->buffer.size()) {
+	throw std::invalid_argument("Cannot write file for output!");
+    }
+    this->num_bytes += this->buffer.size();
+    this->buffer.clear();
+}
+
+void WorkflowJSONWriter::close() {
+    this->flush();
+    int status = fclose(this->file);
+    this->file = nullptr;
+    if (status != 0) {
+	throw std::invalid_argument("Cannot write file for output!");
+    }
+}
+
+void WorkflowJSONWriter::newLine() {
+    if (this->compact) return;
+    this->buffer += '\n';
+    this->buffer.append(this->counts.size() * 4, ' ');
+}
+
+/* Separator and indentation in front of a value (or of a key inside an object) */
+void WorkflowJSONWriter::beginValue() {
+    if (this->buffer.size() >= buffer_size) {
+	this->flush();
+    }
+    if (this->after_key) {
+	this->after_key = false;
+	return;
+    }
+    if (not this->counts.empty()) {
+	if (this->counts.back()++ > 0) this->buffer += ',';
+	this->newLine();
+    }
+}
+
+void WorkflowJSONWriter::beginObject() {
+    this->beginValue();
+    this->buffer += '{';
+    this->counts.push_back(0);
+}
+
+void WorkflowJSONWriter::beginArray() {
+    this->beginValue();
+    this->buffer += '[';
+    this->counts.push_back(0);
+}
+
+void WorkflowJSONWriter::end(char bracket) {
+    long count = this->counts.back();
+    this->counts.pop_back();
+    if (count > 0) this->newLine(); // empty containers stay on one line
+    this->buffer += bracket;
+}
+
+void WorkflowJSONWriter::endObject() {
+    this->end('}');
+}
+
+void WorkflowJSONWriter::endArray() {
+    this->end(']');
+}
+
+void WorkflowJSONWriter::key(std::string_view name) {
+    this->beginValue();
+    this->writeString(name);
+    this->buffer += this->compact ? ":" : ": ";
+    this->after_key = true;
+}
+
+void WorkflowJSONWriter::value(std::string_view string_value) {
+    this->beginValue();
+    this->writeString(string_value);
+}
+
+void WorkflowJSONWriter::value(long number) {
+    this->beginValue();
+    char digits[24];
+    this->buffer.append(digits, std::to_chars(digits, digits + sizeof(digits), number).ptr);
+}
+
+/* Shortest round-trip digits, laid out like nlohmann: fixed notation for
+ * decimal exponents in (-4, 15], ".0" on integral values, else d.ddde+XX */
+void WorkflowJSONWriter::value(double number) {
+    this->beginValue();
+    if (not std::isfinite(number)) {
+	this->buffer += "null";
+	return;
+    }
+    if (std::signbit(number)) {
+	this->buffer += '-';
+	number = -number;
+    }
+    if (number == 0) {
+	this->buffer += "0.0";
+	return;
+    }
+
+    char scientific[32];
+    char* scientific_end = std::to_chars(scientific, scientific + sizeof(scientific), number, std::chars_format::scientific).ptr;
+    char* e = static_cast<char*>(memchr(scientific, 'e', scientific_end - scientific));
+    std::string digits;
+    for (char* c = scientific; c < e; c++) {
+	if (*c != '.') digits += *c;
+    }
+    int exponent = 0;
+    std::from_chars(e + (e[1] == '+' ? 2 : 1), scientific_end, exponent);
+
+    int k = digits.size();
+    int n = exponent + 1; // position of the decimal point
+    if (k <= n && n <= 15) {
+	this->buffer += digits;
+	this->buffer.append(n - k, '0');
+	this->buffer += ".0";
+    } else if (0 < n && n <= 15) {
+	this->buffer.append(digits, 0, n);
+	this->buffer += '.';
+	this->buffer.append(digits, n, std::string::npos);
+    } else if (-4 < n && n <= 0) {
+	this->buffer += "0.";
+	this->buffer.append(-n, '0');
+	this->buffer += digits;
+    } else {
+	this->buffer += digits[0];
+	if (k > 1) {
+	    this->buffer += '.';
+	    this->buffer.append(digits, 1, std::string::npos);
+	}
+	this->buffer += exponent < 0 ? "e-" : "e+";
+	int abs_exponent = std::abs(exponent);
+	if (abs_exponent < 10) this->buffer += '0';
+	this->buffer += std::to_string(abs_exponent);
+    }
+}
+
+void WorkflowJSONWriter::writeString(std::string_view string_value) {
+    static const char hex[] = "0123456789abcdef";
+    this->buffer += '"';
+    for (unsigned char c : string_value) {
+	switch (c) {
+	    case '"': this->buffer += "\\\""; break;
+	    case '\\': this->buffer += "\\\\"; break;
+	    case '\b': this->buffer += "\\b"; break;
+	    case '\f': this->buffer += "\\f"; break;
+	    case '\n': this->buffer += "\\n"; break;
+	    case '\r': this->buffer += "\\r"; break;
+	    case '\t': this->buffer += "\\t"; break;
+	    default:
+		if (c < 0x20) {
+		    this->buffer += "\\u00";
+		    this->buffer += hex[c >> 4];
+		    this->buffer += hex[c & 0xf];
+		} else {
+		    this->buffer += c;
+		}
+	}
+    }
+    this->buffer += '"';
+}
@@ -0,0 +1,50 @@
+#ifndef TRACE_TO_WORKFLOWS_WORKFLOWJSONWRITER_H
+#define TRACE_TO_WORKFLOWS_WORKFLOWJSONWRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* Streaming JSON writer into a buffered file. Keys are written in the order
+ * they are given, so callers emit them alphabetically to get the same text as
+ * nlohmann::json::dump(); numbers and escapes follow nlohmann as well. */
+class WorkflowJSONWriter {
+
+    public:
+        WorkflowJSONWriter(const std::string& file_path, bool compact = false);
+        ~WorkflowJSONWriter();
+        WorkflowJSONWriter(const WorkflowJSONWriter&) = delete;
+        WorkflowJSONWriter& operator=(const WorkflowJSONWriter&) = delete;
+
+        void beginObject();
+        void endObject();
+        void beginArray();
+        void endArray();
+        void key(std::string_view name);
+        void value(std::string_view string_value);
+        void value(const char* string_value) { this->value(std::string_view(string_value)); }
+        void value(const std::string& string_value) { this->value(std::string_view(string_value)); }
+        void value(double number);
+        void value(long number);
+        void value(int number) { this->value((long) number); }
+        void close();
+        uint64_t getNumBytes() const { return this->num_bytes + this->buffer.size(); }
+
+    private:
+        void beginValue();
+        void end(char bracket);
+        void newLine();
+        void writeString(std::string_view string_value);
+        void flush();
+
+        FILE* file;
+        std::string buffer;
+        bool compact;
+        uint64_t num_bytes = 0; // flushed to the file so far
+        bool after_key = false;
+        std::vector<long> counts; // number of values written in each open container
+};
+
+#endif // TRACE_TO_WORKFLOWS_WORKFLOWJSONWRITER_H
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+#include "MappedCSVReader.h"
+#include "InstanceRecord.h"
+#include "ShardedTraceReader.h"
+
+/* Report the parsing throughput of the mapped reader on the first slice of batch_instance.csv */
+int main(int argc, char **argv) {
+
+    int num_threads = 1;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; i++) {
+	if (strncmp(argv[i], "--threads=", 10) == 0) {
+	    num_threads = std::max(1, std::atoi(argv[i] + 10));
+	} else {
+	    args.push_back(argv[i]);
+	}
+    }
+
+    if (args.size() != 2 and args.size() != 3) {
+	std::cerr << "Usage: " << argv[0] << " <batch_instance.csv> [slice size (GB), default 10] [--threads=N]" << std::endl;
+	exit(1);
+    }
+
+    std::string trace_file_path = args[1];
+    double slice_gb = args.size() == 3 ? std::atof(args[2]) : 10.0;
+
+    MappedFile trace(trace_file_path);
+    long slice_size = std::min((long) trace.getSize(), (long) (slice_gb * (1L << 30)));
+    const char* slice_end = trace.begin() + slice_size;
+    while (slice_end > trace.begin() && slice_end < trace.end() && slice_end[-1] != '\n') slice_end++;
+
+    std::cerr << "Trace file:\t" << trace_file_path << std::endl;
+    std::cerr << "Slice size:\t" << (double) (slice_end - trace.begin()) / (1L << 30) << " GB" << std::endl;
+    std::cerr << "Threads:\t" << num_threads << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    long rows = 0;
+    long bytes_parsed = 0;
+    double checksum = 0;
+
+    if (num_threads == 1) {
+	MappedCSVReader task_trace(trace.begin(), slice_end, trace_file_path);
+	InstanceRecord r;
+	while (readInstanceRow(task_trace, r)) {
+	    checksum += r.start_time;
+	    rows++;
+	}
+	bytes_parsed = task_trace.getPosition() - trace.begin();
+    } else {
+	ShardedTraceReader task_trace(trace, num_threads, 16L << 20, [](InstanceRecord&) {});
+	task_trace.setLimit(slice_end - trace.begin());
+	std::vector<std::vector<InstanceRecord>> shards;
+	while (task_trace.readBatch(shards)) {
+	    for (auto& shard : shards) {
+		for (auto& r : shard) {
+		    checksum += r.start_time;
+		    rows++;
+		}
+	    }
+	}
+	bytes_parsed = task_trace.getOffset();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::fixed << std::setprecision(2)
+	      << "Rows:\t\t" << rows << std::endl
+	      << "Time:\t\t" << seconds << " s" << std::endl
+	      << "Throughput:\t" << rows / seconds << " rows/s, "
+	      << bytes_parsed / seconds / (1 << 20) << " MB/s" << std::endl;
+    std::cerr << "(checksum " << checksum << ")" << std::endl;
+
+    return 0;
+}
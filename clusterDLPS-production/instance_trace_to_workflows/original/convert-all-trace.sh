@@ -16,6 +16,5 @@ do
 #    done
 done
 
-./trace2workflows ${START_OFFSET} ${DURATION} 0.015 1000
-
-./trace2swf
+# Workflows and the background load for the simulator (one SWF file per hour window, and the whole trace) in one run
+./trace2all ${START_OFFSET} ${DURATION} 0.015 1000 --threads=`nproc` --writers=`nproc` --swf-windows=${START_OFFSET},${DURATION} --swf-whole --swf-threads=`nproc`
@@ -0,0 +1,136 @@
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <vector>
+#include <string>
+
+#include "MappedCSVReader.h"
+#include "StringInterner.h"
+#include "ColumnarTrace.h"
+
+/* Seconds of trace time per bucket of rows, see bucketRows() */
+static const double bucket_length = 3600;
+
+/* CSV column of the schema column with the given name, -1 if there is none */
+static int findCSVColumn(const std::vector<ColumnSpec>& schema, const std::string& name) {
+    for (auto& spec : schema) {
+	if (spec.name == name) return spec.csv_column;
+    }
+    return -1;
+}
+
+/*
+ * The CSV traces are not sorted by time, so row groups taken in file order would each
+ * span the whole trace and their zone maps would filter nothing. The lines are split into
+ * one temporary file per hour of their job's first start time (or of their own time
+ * without a job column), keeping all instances of a job together and in file order,
+ * and the buckets are returned in time order.
+ */
+static std::vector<std::string> bucketRows(const std::string& trace_file_path, const std::string& output_path,
+					   const std::vector<ColumnSpec>& schema, int num_csv_columns) {
+
+    int time_column = findCSVColumn(schema, "start_time");
+    if (time_column < 0) time_column = findCSVColumn(schema, "time_stamp");
+    int job_column = findCSVColumn(schema, "job_name");
+    if (time_column < 0) {
+	throw std::invalid_argument("No time column to order the rows by");
+    }
+
+    MappedFile trace(trace_file_path);
+    std::vector<std::string_view> fields(num_csv_columns);
+
+    /* First start time of each job */
+    StringInterner job_names;
+    std::vector<double> job_start_times;
+    if (job_column >= 0) {
+	MappedCSVReader reader(trace.begin(), trace.end(), trace_file_path);
+	while (reader.readRow(fields.data(), num_csv_columns)) {
+	    double start_time = 0;
+	    MappedCSVReader::parse(fields[time_column], start_time);
+	    uint32_t id = job_names.intern(fields[job_column]);
+	    if (id >= job_start_times.size()) job_start_times.resize(id + 1, start_time);
+	    job_start_times[id] = std::min(job_start_times[id], start_time);
+	}
+	std::cerr << "Found " << job_names.size() << " jobs." << std::endl;
+    }
+
+    std::map<long, std::pair<std::string, FILE*>> buckets;
+    MappedCSVReader reader(trace.begin(), trace.end(), trace_file_path);
+    std::string_view line;
+    while (reader.readLine(line)) {
+	reader.splitRow(line, fields.data(), num_csv_columns);
+	double time = 0;
+	if (job_column >= 0) {
+	    uint32_t id = 0;
+	    job_names.lookup(fields[job_column], id);
+	    time = job_start_times[id];
+	} else {
+	    MappedCSVReader::parse(fields[time_column], time);
+	}
+	long bucket = (long) std::floor(time / bucket_length);
+
+	auto it = buckets.find(bucket);
+	if (it == buckets.end()) {
+	    std::string path = output_path + ".bucket" + std::to_string(bucket) + ".tmp";
+	    FILE* file = fopen(path.c_str(), "w");
+	    if (file == nullptr) {
+		throw std::invalid_argument("Cannot open temporary file " + path);
+	    }
+	    it = buckets.emplace(bucket, std::make_pair(path, file)).first;
+	}
+	if (fwrite(line.data(), 1, line.size(), it->second.second) != line.size() or fputc('\n', it->second.second) == EOF) {
+	    throw std::invalid_argument("Cannot write temporary file " + it->second.first);
+	}
+    }
+
+    std::vector<std::string> bucket_paths;
+    for (auto& bucket : buckets) {
+	if (ferror(bucket.second.second) or fclose(bucket.second.second) != 0) {
+	    throw std::invalid_argument("Cannot write temporary file " + bucket.second.first);
+	}
+	bucket_paths.push_back(bucket.second.first);
+    }
+    return bucket_paths;
+}
+
+/* One-time conversion of an Alibaba CSV trace into the columnar format read by the converters */
+int main(int argc, char **argv) {
+
+    if (argc != 4) {
+	std::cerr << "Usage: " << argv[0] << " <batch_instance|sample_instance|container_meta> <input CSV> <output file>" << std::endl;
+	exit(1);
+    }
+
+    std::string schema_name = argv[1];
+    std::string trace_file_path = argv[2];
+    std::string output_path = argv[3];
+
+    int num_csv_columns = 0;
+    std::vector<ColumnSpec> schema = getColumnarSchema(schema_name, num_csv_columns);
+
+    std::cerr << "Trace file:\t" << trace_file_path << std::endl;
+    std::cerr << "Output file:\t" << output_path << std::endl;
+
+    std::vector<std::string> bucket_paths = bucketRows(trace_file_path, output_path, schema, num_csv_columns);
+    std::cerr << "Split rows into " << bucket_paths.size() << " buckets of " << bucket_length << " s." << std::endl;
+
+    ColumnarTraceWriter writer(output_path, schema);
+    std::vector<std::string_view> fields(num_csv_columns);
+    for (size_t b = 0; b < bucket_paths.size(); b++) {
+	{
+	    MappedFile bucket(bucket_paths[b]);
+	    MappedCSVReader reader(bucket.begin(), bucket.end(), bucket_paths[b]);
+	    while (reader.readRow(fields.data(), num_csv_columns)) {
+		writer.addRow(fields.data());
+	    }
+	}
+	remove(bucket_paths[b].c_str());
+	std::cerr << "Wrote " << std::setw(10) << (double) (b + 1) / bucket_paths.size() * 100 << "\% of buckets...\r";
+    }
+    writer.close();
+
+    std::cerr << std::endl << "Wrote " << writer.getNumRows() << " rows." << std::endl;
+
+    return 0;
+}
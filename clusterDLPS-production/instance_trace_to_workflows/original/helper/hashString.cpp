@@ -0,0 +1,15 @@
+#include <vector>
+#include <string>
+#include "helper.h"
+
+/* 64-bit FNV-1a of a name, followed by the SplitMix64 finalizer to spread the bits */
+uint64_t hashString(std::string_view string_in) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : string_in) {
+	hash ^= c;
+	hash *= 1099511628211ULL;
+    }
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 31);
+}
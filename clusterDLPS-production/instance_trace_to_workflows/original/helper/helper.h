@@ -1,2 +1,6 @@
+#include <cstdint>
+#include <string_view>
 
 std::vector<std::string> splitString(std::string string_in, std::string delimiter);
+long parseHostId(std::string_view machine_id);
+uint64_t hashString(std::string_view string_in);
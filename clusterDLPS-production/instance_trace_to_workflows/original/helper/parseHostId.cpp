@@ -0,0 +1,16 @@
+#include <vector>
+#include <string>
+#include <charconv>
+#include <stdexcept>
+#include "helper.h"
+
+/* Static host index of a machine id such as "m_1932", i.e. its last "_" field minus one */
+long parseHostId(std::string_view machine_id) {
+    std::string_view number = machine_id.substr(machine_id.rfind('_') + 1);
+    long host_id = 0;
+    auto result = std::from_chars(number.data(), number.data() + number.size(), host_id);
+    if (result.ec != std::errc() || result.ptr != number.data() + number.size() || number.empty()) {
+	throw std::invalid_argument("Invalid machine id \"" + std::string(machine_id) + "\"");
+    }
+    return host_id - 1;
+}
@@ -0,0 +1,60 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <future>
+#include <chrono>
+#include <string.h>
+
+#include "MachineMap.h"
+#include "Converters.h"
+
+/* Runs trace2workflows and trace2swf in one go, each on its own thread, with one
+ * machine map shared between them. Arguments starting with --swf- go to the SWF
+ * conversion as --<rest>, everything else to the workflow conversion. */
+int main(int argc, char **argv) {
+
+    std::vector<std::string> swf_args = {argv[0]};
+    std::vector<char*> workflow_args = {argv[0]};
+    for (int i = 1; i < argc; i++) {
+	if (strncmp(argv[i], "--swf-", 6) == 0) {
+	    swf_args.push_back(std::string("--") + (argv[i] + 6));
+	} else {
+	    workflow_args.push_back(argv[i]);
+	}
+    }
+    std::vector<char*> swf_argv;
+    for (auto& arg : swf_args) swf_argv.push_back(&arg[0]);
+
+    /* Both command lines are checked here, before either conversion starts */
+    WorkflowOptions workflow_options;
+    SWFOptions swf_options;
+    if (not parseWorkflowOptions(workflow_args.size(), workflow_args.data(), workflow_options)
+	    or not parseSWFOptions(swf_argv.size(), swf_argv.data(), swf_options)) {
+	std::cerr << "Usage: " << argv[0] << " <arguments of trace2workflows> [--swf-<option of trace2swf>...]" << std::endl;
+	return 1;
+    }
+
+    MachineMap machines;
+    ConverterStats workflow_stats;
+    ConverterStats swf_stats;
+
+    auto begin = std::chrono::steady_clock::now();
+    auto swf = std::async(std::launch::async, convertSWF, std::cref(swf_options), std::ref(machines), std::ref(swf_stats));
+    int result = convertWorkflows(workflow_options, machines, workflow_stats);
+    result |= swf.get();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    ConverterStats total;
+    total.stage = "total";
+    total.rows_read = workflow_stats.rows_read + swf_stats.rows_read;
+    total.bytes_written = workflow_stats.bytes_written + swf_stats.bytes_written;
+    total.seconds = elapsed.count();
+
+    std::cerr << std::endl;
+    printConverterStats(workflow_stats);
+    printConverterStats(swf_stats);
+    printConverterStats(total);
+    std::cerr << "Machines:\t" << machines.size() << std::endl;
+
+    return result;
+}
@@ -2,33 +2,69 @@
 #include <iomanip>
 #include <utility>
 #include <fstream>
+#include <sstream>
 #include <math.h>
-#include <set>
+#include <unordered_set>
+#include <unordered_map>
 #include <algorithm>
-#include <tuple>
 #include <vector>
+#include <string>
+#include <cstring>
+#include <chrono>
 
-#include "fast-cpp-csv-parser/csv.h"
 #include "helper/helper.h"
+#include "MappedCSVReader.h"
+#include "ColumnarTrace.h"
+#include "ContainerSorter.h"
+#include "MachineMap.h"
+#include "Converters.h"
 
-bool myCompare(const std::tuple<long, long, long, long, long, long>& a,
-	       const std::tuple<long, long, long, long, long, long>& b) {
-    return (
-	(std::get<0>(a) < std::get<0>(b)) ||
-	(std::get<0>(a) == std::get<0>(b) && std::get<5>(a) < std::get<5>(b)) ||
-	(std::get<0>(a) == std::get<0>(b) && std::get<5>(a) == std::get<5>(b) && std::get<4>(a) < std::get<4>(b)) ||
-	(std::get<0>(a) == std::get<0>(b) && std::get<5>(a) == std::get<5>(b) && std::get<4>(a) == std::get<4>(b) && std::get<3>(a) < std::get<3>(b))
-    );
+/* First "started" record of a container and the last time it was seen */
+struct ContainerLifetime {
+    bool started;
+    long start_time;
+    long last_time;
+    long avg_cpu;
+    long max_cpu;
+    long host_id;
+};
+
+bool parseSWFOptions(int argc, char **argv, SWFOptions& options) {
+    for (int i = 1; i < argc; i++) {
+	if (strncmp(argv[i], "--threads=", 10) == 0) {
+	    options.num_threads = std::max(1, std::atoi(argv[i] + 10));
+	} else if (strncmp(argv[i], "--memory=", 9) == 0) {
+	    options.memory_budget = std::max(1L, std::atol(argv[i] + 9)) << 20;
+	} else if (strncmp(argv[i], "--windows=", 10) == 0 and strchr(argv[i], ',')) {
+	    options.windowed = true;
+	    options.window_offset = std::atol(argv[i] + 10) * 3600;
+	    options.num_windows = std::max(0, std::atoi(strchr(argv[i], ',') + 1));
+	} else if (strcmp(argv[i], "--whole") == 0) {
+	    options.whole_trace = true;
+	} else if (strcmp(argv[i], "--columnar") == 0) {
+	    options.columnar_path = "trace/container_meta.col";
+	} else if (strncmp(argv[i], "--columnar=", 11) == 0) {
+	    options.columnar_path = argv[i] + 11;
+	} else {
+	    std::cerr << "Usage: " << argv[0] << " [--columnar[=file]] [--threads=N] [--memory=MB] [--windows=<start offset (hrs)>,<duration (hrs)> [--whole]]" << std::endl;
+	    return false;
+	}
+    }
+    return true;
 }
 
-int main(int argc, char **argv) {
+int convertSWF(const SWFOptions& options, MachineMap& machines, ConverterStats& stats) {
 
-    if (argc != 1) {
-	std::cerr << "Usage: " << argv[0] << std::endl;
-	exit(1);
-    }
+    auto begin = std::chrono::steady_clock::now();
+    std::string columnar_path = options.columnar_path;
+    int num_threads = options.num_threads;
+    long memory_budget = options.memory_budget;
+    bool windowed = options.windowed;
+    long window_offset = options.window_offset;
+    int num_windows = options.num_windows;
+    bool whole_trace = not windowed or options.whole_trace;
     
-    std::string trace_file_path = "trace/container_meta.csv";
+    std::string trace_file_path = columnar_path.empty() ? "trace/container_meta.csv" : columnar_path;
     std::string output_path = "output/swf/";
 
     std::cerr << "Trace file:\t" << trace_file_path << std::endl;
@@ -37,68 +73,193 @@ int main(int argc, char **argv) {
     int max_num_machine = 4096;
     const int num_container_column = 8;
 
-    /* Open instance trace */
-    io::CSVReader<num_container_column> container_trace(trace_file_path);
+    /* One file for the whole trace, or one per hour window named like the workflow directories */
     std::ofstream file;
     file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
-    try {
-        file.open(output_path + "container_trace.swf");
-    } catch (const std::ofstream::failure &e) {
-        throw std::invalid_argument("Cannot open file for output!");
+    int open_window = -1;
+    uint64_t bytes_written = 0;
+    auto openWindow = [&](int window) {
+	while (open_window < window) {
+	    open_window++;
+	    std::string file_name = windowed ? std::to_string(open_window) + "-" + std::to_string(open_window + 1) + ".swf" : "container_trace.swf";
+	    try {
+		if (file.is_open()) {
+		    bytes_written += file.tellp();
+		    file.close();
+		}
+		file.open(output_path + file_name);
+	    } catch (const std::ofstream::failure &e) {
+		throw std::invalid_argument("Cannot open file for output!");
+	    }
+	}
+    };
+    if (not windowed) openWindow(0);
+
+    /* With windows and --whole, the single trace file too, from records of window -1 */
+    std::ofstream whole_file;
+    whole_file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    if (windowed and whole_trace) {
+	try {
+	    whole_file.open(output_path + "container_trace.swf");
+	} catch (const std::ofstream::failure &e) {
+	    throw std::invalid_argument("Cannot open file for output!");
+	}
     }
+    int32_t whole_window = windowed ? -1 : 0;
    
-    std::string container_id;
-    std::string machine_id;
-    long start_time;
-    std::string app_du;
-    std::string status;
-    long avg_cpu;
-    long max_cpu;
-    double avg_mem;
-
     long lines_read = 0;
     long valid_containers = 0;
     long wait_time = 0;
     long run_time = 864000;
-    std::set<std::string> containers;
-    std::vector<std::tuple<long, long, long, long, long, long>> trace;
 
-    while (container_trace.read_row(container_id, machine_id, start_time, app_du, status, avg_cpu, max_cpu, avg_mem)) {
+    /* Containers already taken, by 64-bit name hash */
+    std::unordered_set<uint64_t> containers;
+
+    /* With windows, the lifetime of every container, by 64-bit name hash */
+    std::unordered_map<uint64_t, ContainerLifetime> lifetimes;
+    long trace_end = 0;
+    auto trackContainer = [&](uint64_t container_hash, long host_id, long time_stamp, bool started, long avg_cpu, long max_cpu) {
+	auto it = lifetimes.find(container_hash);
+	if (it == lifetimes.end()) {
+	    it = lifetimes.emplace(container_hash, ContainerLifetime{false, 0, time_stamp, 0, 0, host_id}).first;
+	}
+	ContainerLifetime& c = it->second;
+	c.last_time = std::max(c.last_time, time_stamp);
+	if (started and not c.started) {
+	    c = {true, time_stamp, c.last_time, avg_cpu, max_cpu, host_id};
+	}
+    };
+
+    /* Sorted runs spill next to the output once the memory budget is used up */
+    ContainerSorter trace(output_path + "container_run_", memory_budget, num_threads);
+
+    if (not columnar_path.empty()) {
+	ColumnarTrace container_trace(columnar_path);
+	int container_column = container_trace.findColumn("container_id");
+	int status_column = container_trace.findColumn("status");
+	const int64_t* host_ids = container_trace.getLongs(container_trace.findColumn("host_id"));
+	const int64_t* start_times = container_trace.getLongs(container_trace.findColumn("time_stamp"));
+	const int64_t* avg_cpus = container_trace.getLongs(container_trace.findColumn("cpu_request"));
+	const int64_t* max_cpus = container_trace.getLongs(container_trace.findColumn("cpu_limit"));
+	lines_read = container_trace.getNumRows();
 
-	lines_read++;
-	bool verbose = lines_read % 100 == 0 ? true : false;
-	if (verbose) {
-	    std::cerr << "Read " << std::setw(10) << (double) lines_read / 370540 * 100 << "\% of file...\t"
-		  << "# of containers: " << std::setw(8) << containers.size() <<"\r";
+	for (uint64_t row = 0; row < container_trace.getNumRows(); row++) {
+	    uint64_t container_hash = hashString(container_trace.getString(container_column, row));
+	    if (windowed) {
+		trace_end = std::max<long>(trace_end, start_times[row]);
+		if (host_ids[row] == ColumnarTrace::invalid_host) {
+		    throw std::invalid_argument("Invalid machine id in row " + std::to_string(row) + " of " + columnar_path);
+		}
+		if (host_ids[row] >= max_num_machine) continue;
+		trackContainer(container_hash, host_ids[row], start_times[row], container_trace.getString(status_column, row) == "started",
+			       avg_cpus[row], max_cpus[row]);
+		if (not whole_trace) continue;
+	    }
+
+	    if (containers.find(container_hash) != containers.end()) continue;
+
+	    long host_id = host_ids[row];
+	    if (host_id == ColumnarTrace::invalid_host) {
+		throw std::invalid_argument("Invalid machine id in row " + std::to_string(row) + " of " + columnar_path);
+	    }
+
+	    /* Check machine in range */
+	    if (host_id >= max_num_machine) continue;
+
+	    /* Skip failed task */
+	    if (container_trace.getString(status_column, row) != "started") continue;
+
+	    trace.add({start_times[row], wait_time, run_time, avg_cpus[row]/100, max_cpus[row]/100, (int32_t) host_id, whole_window});
+	    containers.insert(container_hash);
 	}
+    } else {
+	/* Open instance trace */
+	MappedFile trace_file(trace_file_path);
+	MappedCSVReader container_trace(trace_file.begin(), trace_file.end(), trace_file_path);
 
-	if (containers.find(container_id) != containers.end()) continue;
+	std::string_view fields[num_container_column];
+	long start_time;
+	long avg_cpu;
+	long max_cpu;
 
-    	/* Get (long) static host id from machine_id */
-    	std::vector<std::string> machine_id_split = splitString(machine_id, "_");
-    	long host_id = std::stol(machine_id_split.back()) - 1;
+	while (container_trace.readRow(fields, num_container_column)) {
+	    uint64_t container_hash = hashString(fields[0]);
+	    std::string_view machine_id = fields[1];
+	    std::string_view status = fields[4];
 
-	/* Check machine in range */
-	if (host_id >= max_num_machine) continue;
+	    lines_read++;
+	    bool verbose = lines_read % 100 == 0 ? true : false;
+	    if (verbose) {
+		std::ostringstream progress;
+		progress << "Read " << std::setw(10) << (double) lines_read / 370540 * 100 << "\% of file...\t"
+			 << "# of containers: " << std::setw(8) << (windowed ? lifetimes.size() : containers.size());
+		printConverterProgress("swf", progress.str());
+	    }
 
-	/* Skip failed task */
-	if (status != "started") continue;
+	    if (windowed) {
+		long host_id = machines.getHostId(machine_id);
+		MappedCSVReader::parse(fields[2], start_time);
+		trace_end = std::max(trace_end, start_time);
+		if (host_id >= max_num_machine) continue;
+		MappedCSVReader::parse(fields[5], avg_cpu);
+		MappedCSVReader::parse(fields[6], max_cpu);
+		trackContainer(container_hash, host_id, start_time, status == "started", avg_cpu, max_cpu);
+		if (not whole_trace) continue;
+	    }
 
-        trace.push_back(std::make_tuple(start_time, wait_time, run_time, avg_cpu/100, max_cpu/100, host_id));     
-	containers.insert(container_id);
+	    if (containers.find(container_hash) != containers.end()) continue;
+
+	    /* Get (long) static host id from machine_id */
+	    long host_id = machines.getHostId(machine_id);
+
+	    /* Check machine in range */
+	    if (host_id >= max_num_machine) continue;
+
+	    /* Skip failed task */
+	    if (status != "started") continue;
+
+	    MappedCSVReader::parse(fields[2], start_time);
+	    MappedCSVReader::parse(fields[5], avg_cpu);
+	    MappedCSVReader::parse(fields[6], max_cpu);
+	    trace.add({start_time, wait_time, run_time, avg_cpu/100, max_cpu/100, (int32_t) host_id, whole_window});
+	    containers.insert(container_hash);
+	}
     }
 
-    std::sort(trace.begin(), trace.end(), myCompare);
+    /* Cut each container into the hour windows it is alive in. A window gets the
+     * containers started in it, bucketed like the workflows of trace_to_workflows,
+     * and the ones still running from earlier windows, submitted at its beginning.
+     * A container without a later record runs until the end of the trace. */
+    for (auto& it : lifetimes) {
+	const ContainerLifetime& c = it.second;
+	if (not c.started) continue;
 
-    for (auto t : trace) {
-	file << valid_containers++ << " "
-	     << std::get<0>(t) << " "
-             << std::get<1>(t) << " "
-             << std::get<2>(t) << " "
-             << std::get<3>(t) << " "
+	long start = c.start_time - window_offset;
+	long end = (c.last_time > c.start_time ? c.last_time : trace_end) - window_offset;
+	end = std::max(end, start + 1);
+
+	for (int h = start <= 0 ? 0 : (start - 1) / 3600; h < num_windows and h * 3600L < end; h++) {
+	    long submitted = std::max(start, h * 3600L);
+	    trace.add({submitted - h * 3600L, wait_time, end - submitted, c.avg_cpu/100, c.max_cpu/100, (int32_t) c.host_id, h});
+	}
+    }
+
+    long job_id = 0;
+    trace.forEachSorted([&](const ContainerRecord& t) {
+	std::ofstream& out = t.window < 0 ? whole_file : file;
+	if (t.window >= 0 and t.window != open_window) {
+	    openWindow(t.window);
+	    job_id = 0;
+	}
+	valid_containers++;
+	out << job_id++ << " "
+	     << t.start_time << " "
+             << t.wait_time << " "
+             << t.run_time << " "
+             << t.avg_cpu << " "
              << "-1 "
              << "-1 "
-             << std::get<4>(t) << " "
+             << t.max_cpu << " "
              << "-1 "
              << "-1 "
              << "-1 "
@@ -109,11 +270,40 @@ int main(int argc, char **argv) {
              << "-1 "
              << "-1 "
              << "-1 "
-             << std::get<5>(t) << std::endl;
+             << t.host_id << std::endl;
+    });
+
+    openWindow(num_windows - 1);
+    if (file.is_open()) {
+	bytes_written += file.tellp();
+	file.close();
+    }
+    if (whole_file.is_open()) {
+	bytes_written += whole_file.tellp();
+	whole_file.close();
     }
+    printConverterProgress("swf", "Read " + std::to_string(lines_read) + " rows", true);
+    std::cerr << "Sorted " << valid_containers << " containers in " << std::max(1, trace.getNumRuns()) << " run(s)";
+    if (windowed) std::cerr << " into " << num_windows << " window(s) of " << lifetimes.size() << " container(s)";
+    std::cerr << "." << std::endl;
 
-    file.close();
-    std::cerr << std::endl;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    stats.stage = "swf";
+    stats.rows_read = lines_read;
+    stats.bytes_written = bytes_written;
+    stats.seconds = elapsed.count();
 
     return 0;
 }
+
+#ifndef TRACE_TO_ALL
+int main(int argc, char **argv) {
+    SWFOptions options;
+    if (not parseSWFOptions(argc, argv, options)) return 1;
+    MachineMap machines;
+    ConverterStats stats;
+    int result = convertSWF(options, machines, stats);
+    printConverterStats(stats);
+    return result;
+}
+#endif
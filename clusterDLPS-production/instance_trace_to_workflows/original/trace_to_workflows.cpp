@@ -1,27 +1,44 @@
 #include <iostream>
 #include <iomanip>
 #include <vector>
-#include <list>
+#include <deque>
+#include <unordered_map>
 #include <utility>
 #include <set>
 #include <map>
 #include <fstream>
-#include <nlohmann/json.hpp>
+#include <sstream>
+#include <filesystem>
+#include <future>
+#include <chrono>
+#include <atomic>
 #include <math.h>
 #include <time.h>
+#include <string.h>
 
 #include <wrench-dev.h>
 #include <wrench/util/UnitParser.h>
 
-#include "fast-cpp-csv-parser/csv.h"
 #include "helper/helper.h"
 
 #include "AlibabaJob.h"
-
-int dumpJob(AlibabaJob* job, std::string output_path, double time_out) {
-    double this_time_out = time_out;
+#include "StringInterner.h"
+#include "RejectedJobFilter.h"
+#include "MappedCSVReader.h"
+#include "InstanceRecord.h"
+#include "ColumnarTrace.h"
+#include "ShardedTraceReader.h"
+#include "WorkflowJSONWriter.h"
+#include "JobWriterPool.h"
+#include "CheckpointIO.h"
+#include "MachineMap.h"
+#include "InstanceJitter.h"
+#include "CorpusIndex.h"
+#include "Converters.h"
+
+int dumpJob(AlibabaJob* job, std::string output_path, bool compact, std::atomic<uint64_t>& bytes_written, CorpusIndex& corpus_index) {
     time_t rawtime;
-    struct tm* timeinfo;
+    struct tm timeinfo;
 
     int start_hour = (job->getSubmittedTime() - 1) / 3600;
 
@@ -38,28 +55,20 @@ int dumpJob(AlibabaJob* job, std::string output_path, double time_out) {
 	}
     }
 
-    /* Add task dependencies according to the dependency map */
-    auto d_map = job->getDependencyMap();
-    auto t_map = job->getTaskInstanceMap();
-    auto itd = d_map.begin();
-    while (itd != d_map.end() && this_time_out > 0) {
-	auto child_range = t_map.equal_range(itd->first);
-	auto parent_range = t_map.equal_range(itd->second);
-	auto itc = child_range.first;
-	while (itc != child_range.second && this_time_out > 0) {
-	    auto itp = parent_range.first;
-	    while (itp != parent_range.second && this_time_out > 0) {
-		clock_t time_out_start = clock();
-		tasks[itc->second]->addInputFileWithoutDependencies(job->getFileByID(itp->second + "_output"));
-		job->addControlDependency(tasks[itp->second], tasks[itc->second]);
-	    	this_time_out -= (double) (clock() - time_out_start)/CLOCKS_PER_SEC;
-		itp++;
+    /* Wire parent outputs to child inputs for every dependent instance pair */
+    auto& d_map = job->getDependencyMap();
+    for (auto itd = d_map.begin(); itd != d_map.end(); ++itd) {
+	auto& parent_range = job->getTaskInstances(itd->second);
+	for (auto child_id : job->getTaskInstances(itd->first)) {
+	    auto child = job->getInstance(child_id);
+	    for (auto parent_id : parent_range) {
+		child->addInputFileWithoutDependencies(job->getFileByID(job->getInstance(parent_id)->getID() + "_output"));
 	    }
-	    itc++;
 	}
-	itd++;
     }
-    if (this_time_out <= 0 ) {
+
+    /* Add task dependencies in bulk; a job whose dependencies form a cycle is skipped */
+    if (not job->addTaskDependencies()) {
 	return 0;
     }
 
@@ -84,264 +93,539 @@ int dumpJob(AlibabaJob* job, std::string output_path, double time_out) {
     }
 
 
-    /* Create JSON structure*/
-    nlohmann::json j;
-    j["name"] = job->getName();
-    j["description"] = "This job contains " + std::to_string(job->getNumberOfTasks()) + " tasks.";
+    /* Stream the JSON file for each workflow, keys in the same (sorted) order as nlohmann::json */
+    std::string hour_path = output_path + std::to_string(start_hour) + "-" + std::to_string(start_hour + 1) + "/";
+    std::error_code ec;
+    std::filesystem::create_directories(hour_path, ec);
+    WorkflowJSONWriter w(hour_path + job->getName() + ".json", compact);
     time (&rawtime);
-    timeinfo = localtime (&rawtime);
+    localtime_r(&rawtime, &timeinfo); // dumpJob runs on several writer threads at once
     char buffer [80];
-    strftime(buffer, 80, "%FT%T%z", timeinfo);
-    j["createdAt"] = buffer;
-    j["schemaVersion"] = "1.0";
-    j["author"] = {{"name", "Yuyang Wang"}, {"email", "wyy@ece.ucsb.edu"}, {"institution", "University of California, Santa Barbara"}, {"country", "US"}};
-    j["wms"] = {{"name", "none"}, {"url", "none"}, {"version", "none"}};
-
-    nlohmann::json j_workflow = nlohmann::json::object();
-    j_workflow["makespan"] = -1;
-    j_workflow["executedAt"] = job->getSubmittedTime() - start_hour * 3600;
-    /* nlohmann::json j_machines = nlohmann::json::array();
-    for (int idx_machine = 0; idx_machine < max_num_machine; idx_machine++) {
-	nlohmann::json j_machine = nlohmann::json::object();
-	j_machine["nodeName"] = "none";
-	j_machine["system"] = "linux";
-	j_machine["architecture"] = "x86_64";
-	j_machine["release"] = "none";
-	j_machine["memory"] = 100;
-	j_machine["cpu"] = {{"count", 96}, {"vendor", "none"}, {"speed", 2000}};
-	j_machines.insert(j_machines.end(), j_machine);
-    }
-    j_workflow["machines"] = j_machines; */
-
-    nlohmann::json j_jobs = nlohmann::json::array();
+    strftime(buffer, 80, "%FT%T%z", &timeinfo);
+
+    w.beginObject();
+    w.key("author");
+    w.beginObject();
+    w.key("country"); w.value("US");
+    w.key("email"); w.value("wyy@ece.ucsb.edu");
+    w.key("institution"); w.value("University of California, Santa Barbara");
+    w.key("name"); w.value("Yuyang Wang");
+    w.endObject();
+    w.key("createdAt"); w.value(buffer);
+    w.key("description"); w.value("This job contains " + std::to_string(job->getNumberOfTasks()) + " tasks.");
+    w.key("name"); w.value(job->getName());
+    w.key("schemaVersion"); w.value("1.0");
+    w.key("wms");
+    w.beginObject();
+    w.key("name"); w.value("none");
+    w.key("url"); w.value("none");
+    w.key("version"); w.value("none");
+    w.endObject();
+
+    w.key("workflow");
+    w.beginObject();
+    w.key("executedAt"); w.value(job->getSubmittedTime() - start_hour * 3600);
+    w.key("jobs");
+    w.beginArray();
+    double total_runtime = 0;
     for (auto itt = tasks.begin(); itt != tasks.end(); ++itt) {
-	nlohmann::json j_job = nlohmann::json::object();
-	j_job["name"] = itt->first;
-	j_job["type"] = "compute";
-	j_job["arguments"] = nlohmann::json::array({"none"});
-	j_job["runtime"] = itt->second->getFlops();
-	j_job["cores"] = 1;
-	j_job["avgCPU"] = itt->second->getAverageCPU();
-	j_job["memory"] = itt->second->getMemoryRequirement()*100;
-	j_job["energy"] = -1;
-	j_job["avgPower"] = -1;
-	j_job["priority"] = 0;
-	j_job["machine"] = std::to_string(itt->second->getStaticHost());
-	j_job["endTimeInTrace"] = itt->second->getStaticEndTime() - start_hour * 3600;
-	j_job["startTimeInTrace"] = itt->second->getStaticStartTime() - start_hour * 3600;	   
- 
-	nlohmann::json j_parents = nlohmann::json::array();
-	auto parents = itt->second->getParents();
-	for (auto p : parents) {
-	    j_parents.insert(j_parents.end(), p->getID());
-	}
-	j_job["parents"] = j_parents;
-
-	nlohmann::json j_files = nlohmann::json::array();
+	total_runtime += itt->second->getFlops();
 	auto input_files = itt->second->getInputFiles();
+	auto output_files = itt->second->getOutputFiles();
 	double bytes_read = 0;
 	for (auto f: input_files) {
-	    j_files.insert(j_files.end(), nlohmann::json::object(
-		{{"name", f->getID()}, {"size", (long) f->getSize()}, {"link", "input"}}));
 	    bytes_read += f->getSize();
 	}
-	auto output_files = itt->second->getOutputFiles();
 	double bytes_written = 0;
 	for (auto f: output_files) {
-	    j_files.insert(j_files.end(), nlohmann::json::object(
-		{{"name", f->getID()}, {"size", (long) f->getSize()}, {"link", "output"}}));
 	    bytes_written += f->getSize();
 	}
-	j_job["files"] = j_files;
-	j_job["bytesRead"] = bytes_read;
-	j_job["bytesWritten"] = bytes_written;
 
-	j_jobs.insert(j_jobs.end(), j_job);
-    }
-    j_workflow["jobs"] = j_jobs;
-
-    j["workflow"] = j_workflow;
-
-    /* Write a JSON file for each workflow*/
-    std::ofstream file;
-    file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
-    try {
-	file.open(output_path + std::to_string(start_hour) + "-" + std::to_string(start_hour + 1) + "/" + job->getName() + ".json");
-	file << j.dump(4);
-	file.close();
-    } catch (const std::ofstream::failure &e) {
-	throw std::invalid_argument("Cannot open file for output!");
+	w.beginObject();
+	w.key("arguments");
+	w.beginArray();
+	w.value("none");
+	w.endArray();
+	w.key("avgCPU"); w.value(itt->second->getAverageCPU());
+	w.key("avgPower"); w.value(-1);
+	w.key("bytesRead"); w.value(bytes_read);
+	w.key("bytesWritten"); w.value(bytes_written);
+	w.key("cores"); w.value(1);
+	w.key("endTimeInTrace"); w.value(itt->second->getStaticEndTime() - start_hour * 3600);
+	w.key("energy"); w.value(-1);
+
+	w.key("files");
+	w.beginArray();
+	for (auto f: input_files) {
+	    w.beginObject();
+	    w.key("link"); w.value("input");
+	    w.key("name"); w.value(f->getID());
+	    w.key("size"); w.value((long) f->getSize());
+	    w.endObject();
+	}
+	for (auto f: output_files) {
+	    w.beginObject();
+	    w.key("link"); w.value("output");
+	    w.key("name"); w.value(f->getID());
+	    w.key("size"); w.value((long) f->getSize());
+	    w.endObject();
+	}
+	w.endArray();
+
+	w.key("machine"); w.value(std::to_string(itt->second->getStaticHost()));
+	w.key("memory"); w.value(itt->second->getMemoryRequirement()*100);
+	w.key("name"); w.value(itt->first);
+
+	w.key("parents");
+	w.beginArray();
+	auto parents = itt->second->getParents();
+	for (auto p : parents) {
+	    w.value(p->getID());
+	}
+	w.endArray();
+
+	w.key("priority"); w.value(0);
+	w.key("runtime"); w.value(itt->second->getFlops());
+	w.key("startTimeInTrace"); w.value(itt->second->getStaticStartTime() - start_hour * 3600);
+	w.key("type"); w.value("compute");
+	w.endObject();
     }
+    w.endArray();
+    w.key("makespan"); w.value(-1);
+    w.endObject();
+
+    w.endObject();
+    uint64_t num_bytes = w.getNumBytes();
+    w.close();
+    bytes_written += num_bytes;
+
+    corpus_index.add(hour_path, {job->getName() + ".json", job->getSubmittedTime() - start_hour * 3600, (long) tasks.size(), total_runtime, num_bytes});
 
     return 1;
 }
 
-int main(int argc, char **argv) {
+bool parseWorkflowOptions(int argc, char **argv, WorkflowOptions& options) {
+
+    /* Separate optional flags from positional arguments */
+    std::vector<char*> args;
+    for (int i = 0; i < argc; i++) {
+	if (strncmp(argv[i], "--threads=", 10) == 0) {
+	    options.num_threads = std::max(1, std::atoi(argv[i] + 10));
+	} else if (strncmp(argv[i], "--shard-size=", 13) == 0) {
+	    options.shard_size = std::max(1L, std::atol(argv[i] + 13)) << 20;
+	} else if (strncmp(argv[i], "--fp-rate=", 10) == 0) {
+	    options.fp_rate = std::atof(argv[i] + 10);
+	} else if (strncmp(argv[i], "--expected-jobs=", 16) == 0) {
+	    options.expected_jobs = std::atol(argv[i] + 16);
+	} else if (strncmp(argv[i], "--writers=", 10) == 0) {
+	    options.num_writers = std::max(0, std::atoi(argv[i] + 10));
+	} else if (strcmp(argv[i], "--columnar") == 0) {
+	    options.columnar_path = "trace/batch_instance.col";
+	} else if (strncmp(argv[i], "--columnar=", 11) == 0) {
+	    options.columnar_path = argv[i] + 11;
+	} else if (strcmp(argv[i], "--checkpoint") == 0) {
+	    options.checkpoint_path = "output/trace2workflows.ckpt";
+	} else if (strncmp(argv[i], "--checkpoint=", 13) == 0) {
+	    options.checkpoint_path = argv[i] + 13;
+	} else if (strncmp(argv[i], "--checkpoint-interval=", 22) == 0) {
+	    options.checkpoint_interval = std::atof(argv[i] + 22);
+	} else if (strcmp(argv[i], "--resume") == 0) {
+	    options.resume = true;
+	} else if (strcmp(argv[i], "--compact") == 0) {
+	    options.compact = true;
+	} else if (strcmp(argv[i], "--legacy-jitter") == 0) {
+	    options.legacy_jitter = true;
+	} else {
+	    args.push_back(argv[i]);
+	}
+    }
 
-    if (argc != 5) {
-	std::cerr << "Usage: " << argv[0] << "<start time offset (hrs)> <duration (hrs)> <time out (s)> <dump interval>" << std::endl;
-	exit(1);
+    if (args.size() != 5) {
+	std::cerr << "Usage: " << argv[0] << "<start time offset (hrs)> <duration (hrs)> <time out (s), unused> <dump interval> [--threads=N] [--shard-size=MB] [--fp-rate=P] [--expected-jobs=N] [--compact] [--legacy-jitter] [--writers=N] [--columnar[=file]] [--checkpoint[=file]] [--checkpoint-interval=S] [--resume]" << std::endl;
+	return false;
     }
-    
+
+    options.start_time_offset = std::atoi(args[1]);
+    options.trace_duration = std::atoi(args[2]);
+    /* args[3] (time out) is no longer needed since dependencies are added in bulk */
+    options.dump_interval = std::atoi(args[4]);
+    return true;
+}
+
+int convertWorkflows(const WorkflowOptions& options, MachineMap& machines, ConverterStats& stats) {
+
+    auto begin = std::chrono::steady_clock::now();
+
+    int num_threads = options.num_threads;
+    long shard_size = options.shard_size;
+    bool compact = options.compact;
+    int num_writers = options.num_writers;
+    std::string columnar_path = options.columnar_path;
+    std::string checkpoint_path = options.checkpoint_path;
+    double checkpoint_interval = options.checkpoint_interval;
+    bool resume = options.resume;
+    bool legacy_jitter = options.legacy_jitter;
+
     const int max_num_machine = 4096;
-    int start_time_offset = std::atoi(argv[1]);
-    int trace_duration = std::atoi(argv[2]);
-    double time_out = std::atof(argv[3]);
-    int dump_interval = std::atoi(argv[4]);
+    int start_time_offset = options.start_time_offset;
+    int trace_duration = options.trace_duration;
+    int dump_interval = options.dump_interval;
 
     std::string trace_file_path = "trace/batch_instance.csv";
     std::string output_path = "output/workflows_without_file_size/";
 
+    if (not columnar_path.empty()) {
+	trace_file_path = columnar_path;
+    }
+    if (resume and checkpoint_path.empty()) {
+	checkpoint_path = "output/trace2workflows.ckpt";
+    }
+
     std::cerr << "Trace file:\t" << trace_file_path << std::endl;
     std::cerr << "Output Path:\t" << output_path << std::endl;
+    std::cerr << "Threads:\t" << num_threads << std::endl;
+    std::cerr << "Writers:\t" << num_writers << std::endl;
+    if (not checkpoint_path.empty()) {
+	std::cerr << "Checkpoint:\t" << checkpoint_path << std::endl;
+    }
 
     /* Add another big offset to start time */
 //    start_time_offset = start_time_offset + 48;
 
-    const int num_instance_column = 14;
+    /* Window and machine range, checked on the raw fields of a row before it is read */
+    InstanceFilter filter = {(double) start_time_offset * 3600, (double) (start_time_offset + trace_duration) * 3600, max_num_machine};
 
-    /* Open instance trace */
-    io::CSVReader<num_instance_column> task_trace(trace_file_path);
-    
-    std::string instance_name;
-    std::string task_name;
-    std::string job_name;
-    std::string task_type;
-    std::string status;
-    double start_time;
-    double end_time;
-    std::string machine_id;
-    long sequence_number;
-    long total_sequence_number;
-    double avg_cpu;
-    double max_cpu;
-    double avg_mem;
-    double max_mem;
-
-    /* Initiate a map of workflows (jobs) as <jobID, workflow>*/
-    std::map<std::string, AlibabaJob*> jobs;
-    std::list<std::string> job_list;
-    std::map<std::string, bool> job_out_of_range;
-//    std::list<std::string> job_out_of_range_list;
+    /* Stateless per-row work: range checks, host id and start/end time jitter.
+     * Only depends on the row itself, so it can run on any parser thread. */
+    auto prepare = [&](InstanceRecord& r) {
 
-    long lines_read = 0;
-    long num_dumped_jobs = 0;
-    while (task_trace.read_row(instance_name, task_name, job_name, task_type, status, start_time, end_time, machine_id, sequence_number, total_sequence_number, avg_cpu, max_cpu, avg_mem, max_mem)) {
+	/* Check start time in range */
+	r.in_range = false;
+	if (r.filtered) return;
+	if (r.start_time <= start_time_offset * 3600 
+		or r.start_time > (start_time_offset + trace_duration) * 3600) {
+	    return;
+	}
 
-	lines_read++;
-	bool verbose = lines_read % 10000 == 0 ? true : false;
-	if (verbose) {
-	    std::cerr << "Read " << std::setw(10) << (double) lines_read / 1351255775 * 100 << "\% of file...\t"
-		  << "# of queued jobs: " << std::setw(6) << jobs.size() << "\t"
-		  << "# of dumped jobs: " << std::setw(8) << num_dumped_jobs <<"\r";
+    	/* Get (long) static host id from machine_id */
+	if (not r.host_parsed) {
+	    r.host_id = machines.getHostId(r.machine_id);
 	}
-	// end_time = max(end_time, start_time + 1);
+
+	/* Check machine in range */
+	if (r.host_id >= max_num_machine) return;
+
+	/* Skip failed task */
+	if (r.status != "Terminated") return;
+
+	r.in_range = true;
 
 	/* Fix identical instance id by sequence number */
-	instance_name = instance_name + "_" + std::to_string(sequence_number);
+	r.instance_id.assign(r.instance_name);
+	r.instance_id += "_" + std::to_string(r.sequence_number);
 
-	/* Check start time in range */
-	if (job_out_of_range[job_name] == true) continue;
-	if (start_time <= start_time_offset * 3600 
-		or start_time > (start_time_offset + trace_duration) * 3600) {
-	    job_out_of_range[job_name] = true;
-//	    job_out_of_range_list.push_back(job_name);
-	    if (jobs.find(job_name) != jobs.end()) {
-		delete jobs[job_name];
-		jobs.erase(job_name);
-	    }
-	    continue;
+	r.start_time = r.start_time - start_time_offset * 3600;
+	r.end_time = r.end_time - start_time_offset * 3600;
+
+	if (legacy_jitter) {
+	    jitterTimesLegacy(r.instance_id, r.start_time, r.end_time);
+	} else {
+	    jitterTimes(hashString(r.instance_id), r.start_time, r.end_time);
 	}
+    };
 
-    	/* Get (long) static host id from machine_id */
-    	std::vector<std::string> machine_id_split = splitString(machine_id, "_");
-    	long host_id = std::stol(machine_id_split.back()) - 1;
+    /* Dense ids for job names and for the task names inside jobs */
+    StringInterner job_names;
+    StringInterner task_names;
 
-	/* Check machine in range */
-	if (host_id >= max_num_machine) {
-	    job_out_of_range[job_name] = true;
-//	    job_out_of_range_list.push_back(job_name);
-	    if (jobs.find(job_name) != jobs.end()) {
-		delete jobs[job_name];
-                jobs.erase(job_name);
-            }
-            continue;
+    /* Initiate a map of workflows (jobs) as <jobID, <workflow, serial>>.
+     * Job ids are recycled once a job leaves the queue, so job_list also
+     * records the serial of each entry to spot entries of a recycled id. */
+    std::unordered_map<uint32_t, std::pair<AlibabaJob*, long>> jobs;
+    std::deque<std::pair<uint32_t, long>> job_list;
+    long num_queued_jobs = 0;
+
+    /* Rejected and dumped jobs only live on in a fixed-size filter */
+    RejectedJobFilter job_out_of_range(options.expected_jobs, options.fp_rate);
+
+    long lines_read = 0;
+
+    /* Dumped jobs are written out by a pool of writer threads; at most
+     * dump_interval of them may wait for a writer before parsing stalls */
+    std::atomic<uint64_t> bytes_written{0};
+    CorpusIndex corpus_index(resume and std::filesystem::exists(checkpoint_path)); // a resumed run adds to the index
+    JobWriterPool writer_pool(num_writers, std::max(1, dump_interval),
+			      [&](AlibabaJob* job) { return dumpJob(job, output_path, compact, bytes_written, corpus_index); });
+
+    /* Progress line, shared with the SWF conversion under trace2all */
+    auto printProgress = [&](bool done) {
+	std::ostringstream progress;
+	progress << "Read " << std::setw(10) << (double) lines_read / 1351255775 * 100 << "\% of file...\t"
+		 << "# of queued jobs: " << std::setw(6) << jobs.size() << "\t"
+		 << "# of dumped jobs: " << std::setw(8) << writer_pool.getNumWritten();
+	printConverterProgress("workflows", progress.str(), done);
+    };
+
+    /* Drop a job from the queue, remember it as done and recycle its id.
+     * A job to dump goes to the writers, which delete it once written. */
+    auto retireJob = [&](std::unordered_map<uint32_t, std::pair<AlibabaJob*, long>>::iterator itj, bool dump) {
+	AlibabaJob* job = itj->second.first;
+	job_out_of_range.insert(job->getName());
+	job_names.release(itj->first);
+	jobs.erase(itj);
+	if (dump) {
+	    job->getDependencyMap(); // sort here, it reads the task names the parser keeps adding to
+	    writer_pool.submit(job);
+	} else {
+	    delete job;
 	}
+    };
 
-	/* Skip failed task */
-	if (status != "Terminated") {
-	    job_out_of_range[job_name] = true;
-//	    job_out_of_range_list.push_back(job_name);
-	    if (jobs.find(job_name) != jobs.end()) {
-		delete jobs[job_name];
-                jobs.erase(job_name);
-            }
-	    continue;
+    /* Stateful per-row work: must see rows in file order */
+    auto consume = [&](InstanceRecord& r) {
+
+	lines_read++;
+	bool verbose = lines_read % 10000 == 0 ? true : false;
+	if (verbose) {
+	    printProgress(false);
+	}
+	// end_time = max(end_time, start_time + 1);
+
+	/* Jobs in flight are looked up exactly, everything else goes through the filter */
+	uint32_t job_id;
+	bool in_flight = job_names.lookup(r.job_name, job_id);
+	if (not in_flight and job_out_of_range.contains(r.job_name)) return;
+
+	/* Reject the whole job on an out-of-range, out-of-cluster or failed instance */
+	if (not r.in_range) {
+	    if (in_flight) {
+		retireJob(jobs.find(job_id), false);
+	    } else {
+		job_out_of_range.insert(r.job_name);
+	    }
+	    return;
 	}
 
-//	/* Limit the size of out-of-range job list */
-//	while (job_out_of_range.size() > 100000) {
-//	    job_out_of_range.erase(job_out_of_range_list.front());
-//	    job_out_of_range_list.pop_front();
-//	}
-
-	start_time = start_time - start_time_offset * 3600;
-	end_time = end_time - start_time_offset * 3600;
-	
-	std::mt19937 rng;
-    	std::seed_seq seed (instance_name.begin(), instance_name.end());
-    	rng.seed(seed);
-   	std::uniform_real_distribution<double> dist1(end_time, end_time + 1);
-        end_time = max(dist1(rng), 0.0);
-   	std::uniform_real_distribution<double> dist2(start_time, min(start_time + 1, end_time));
-        start_time = max(dist2(rng), 0.0);
-	
-	if (jobs.empty() || jobs.find(job_name) == jobs.end()) { /* a new job */
-	    AlibabaJob* job = new AlibabaJob();
-	    job->setName(job_name);
-	    job->setSubmittedTime(start_time);
-	    jobs[job_name] = job->updateJob(task_name, instance_name, start_time, end_time, avg_cpu, avg_mem, host_id);
-	    job_list.push_back(job_name);
+	if (not in_flight) { /* a new job */
+	    job_id = job_names.intern(r.job_name);
+	    AlibabaJob* job = new AlibabaJob(&task_names);
+	    job->setName(job_names.getName(job_id));
+	    job->setSubmittedTime(r.start_time);
+	    job->updateJob(r.task_name, r.instance_id, r.start_time, r.end_time, r.avg_cpu, r.avg_mem, r.host_id);
+	    jobs[job_id] = std::make_pair(job, num_queued_jobs);
+	    job_list.push_back(std::make_pair(job_id, num_queued_jobs));
+	    num_queued_jobs++;
 
 	    /* dump oldest job */
 	    if (jobs.size() > dump_interval) {
-		while (jobs.find(job_list.front()) == jobs.end()) { // Delete invalid jobs
+		while (true) { // Delete invalid jobs
+		    auto itj = jobs.find(job_list.front().first);
+		    if (itj != jobs.end() and itj->second.second == job_list.front().second) break;
 		    job_list.pop_front();
 		}
-		std::string job_to_dump = job_list.front();
-		int is_dumped = dumpJob(jobs[job_to_dump], output_path, time_out);
-		delete jobs[job_to_dump];
-		jobs.erase(job_to_dump);
+		retireJob(jobs.find(job_list.front().first), true);
 		job_list.pop_front();
-		num_dumped_jobs += is_dumped;
-		job_out_of_range[job_to_dump] = true;
-//		job_out_of_range_list.push_back(job_to_dump);
 	    }
 
 	} else { /* existing job */
-	    jobs[job_name] = jobs[job_name]->updateJob(task_name, instance_name, start_time, end_time, avg_cpu, avg_mem, host_id);
+	    jobs[job_id].first->updateJob(r.task_name, r.instance_id, r.start_time, r.end_time, r.avg_cpu, r.avg_mem, r.host_id);
 	}
 
 	if (verbose) {
-	    std::cerr << "Read " << std::setw(10) << (double) lines_read / 1351255775 * 100 << "\% of file...\t"
-		  << "# of queued jobs: " << std::setw(6) << jobs.size() << "\t"
-		  << "# of dumped jobs: " << std::setw(8) << num_dumped_jobs <<"\r";
+	    printProgress(false);
+	}
+    };
+
+    /* Checkpoints hold the position reached in the trace (a byte offset, or a row group
+     * of a columnar trace), the counters, the rejected job filter and the queued jobs.
+     * Dumped jobs are in the filter, so a resumed run skips them. */
+    const char checkpoint_magic[8] = {'T', '2', 'W', 'C', 'K', 'P', 'T', '2'};
+    uint64_t trace_file_size = std::filesystem::file_size(trace_file_path);
+    auto last_checkpoint = std::chrono::steady_clock::now();
+
+    auto checkpointDue = [&]() {
+	if (checkpoint_path.empty()) return false;
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - last_checkpoint;
+	return elapsed.count() >= checkpoint_interval;
+    };
+
+    auto saveCheckpoint = [&](uint64_t position) {
+	writer_pool.drain(); // everything in the filter as dumped must be on disk
+	corpus_index.flush();
+
+	std::ofstream out(checkpoint_path + ".tmp", std::ios::binary);
+	out.write(checkpoint_magic, sizeof(checkpoint_magic));
+	writeBinary(out, trace_file_path);
+	writeBinary(out, trace_file_size);
+	writeBinary(out, start_time_offset);
+	writeBinary(out, trace_duration);
+	writeBinary(out, dump_interval);
+	writeBinary(out, legacy_jitter);
+	writeBinary(out, position);
+	writeBinary(out, lines_read);
+	writeBinary(out, writer_pool.getNumWritten());
+	job_out_of_range.save(out);
+
+	writeBinary(out, (uint64_t) jobs.size());
+	for (auto& entry : job_list) {
+	    auto itj = jobs.find(entry.first);
+	    if (itj == jobs.end() or itj->second.second != entry.second) continue;
+	    itj->second.first->save(out);
+	}
+	out.close();
+	if (not out) {
+	    throw std::invalid_argument("Cannot write checkpoint " + checkpoint_path);
+	}
+	std::filesystem::rename(checkpoint_path + ".tmp", checkpoint_path);
+	last_checkpoint = std::chrono::steady_clock::now();
+    };
+
+    auto loadCheckpoint = [&]() -> uint64_t {
+	std::ifstream in(checkpoint_path, std::ios::binary);
+	char magic[sizeof(checkpoint_magic)];
+	if (not in.read(magic, sizeof(magic)) or memcmp(magic, checkpoint_magic, sizeof(magic)) != 0) {
+	    throw std::invalid_argument("Cannot read checkpoint " + checkpoint_path);
+	}
+	if (readBinaryString(in) != trace_file_path or readBinary<uint64_t>(in) != trace_file_size
+		or readBinary<int>(in) != start_time_offset or readBinary<int>(in) != trace_duration
+		or readBinary<int>(in) != dump_interval or readBinary<bool>(in) != legacy_jitter) {
+	    throw std::invalid_argument("Checkpoint " + checkpoint_path + " was taken for another trace or other arguments");
+	}
+	uint64_t position = readBinary<uint64_t>(in);
+	lines_read = readBinary<long>(in);
+	writer_pool.setNumWritten(readBinary<long>(in));
+	job_out_of_range.load(in);
+
+	uint64_t num_jobs = readBinary<uint64_t>(in);
+	for (uint64_t i = 0; i < num_jobs; i++) {
+	    AlibabaJob* job = AlibabaJob::load(in, &task_names);
+	    uint32_t job_id = job_names.intern(job->getName());
+	    jobs[job_id] = std::make_pair(job, num_queued_jobs);
+	    job_list.push_back(std::make_pair(job_id, num_queued_jobs));
+	    num_queued_jobs++;
+	}
+	return position;
+    };
+
+    uint64_t start_position = 0;
+    if (resume and std::filesystem::exists(checkpoint_path)) {
+	start_position = loadCheckpoint();
+	std::cerr << "Resumed at " << start_position << " with " << jobs.size() << " queued and "
+		  << writer_pool.getNumWritten() << " dumped jobs." << std::endl;
+    }
+
+    if (not columnar_path.empty()) {
+	/* Columnar trace: rows are already parsed, prepare row groups of them in parallel.
+	 * A row group outside of the window or machine range only yields its job names. */
+	ColumnarTrace trace(columnar_path);
+	InstanceColumns columns(trace);
+	long skipped_groups = 0;
+	std::vector<std::vector<InstanceRecord>> slices(num_threads);
+	for (uint64_t group = start_position; group < trace.getNumRowGroups(); group += num_threads) {
+	    std::vector<std::future<void>> workers;
+	    for (int i = 0; i < num_threads; i++) {
+		slices[i].clear();
+		if (group + i >= trace.getNumRowGroups()) continue;
+		ColumnarRowGroup rows = trace.getRowGroup(group + i);
+		bool skip = isRowGroupFiltered(columns, group + i, filter);
+		skipped_groups += skip;
+		workers.push_back(std::async(std::launch::async, [&, i, rows, skip]() {
+		    slices[i].resize(rows.end - rows.begin);
+		    for (uint64_t row = rows.begin; row < rows.end; row++) {
+			InstanceRecord& r = slices[i][row - rows.begin];
+			if (skip) {
+			    readFilteredRow(columns, row, r);
+			} else {
+			    readInstanceRow(columns, row, r, &filter);
+			    prepare(r);
+			}
+		    }
+		}));
+	    }
+	    for (auto& worker : workers) {
+		worker.get();
+	    }
+	    for (auto& slice : slices) {
+		for (auto& r : slice) {
+		    consume(r);
+		}
+	    }
+	    if (checkpointDue()) {
+		saveCheckpoint(group + num_threads);
+	    }
+	}
+	std::cerr << std::endl << "Skipped " << skipped_groups << "/" << trace.getNumRowGroups() << " row groups." << std::endl;
+    } else {
+	/* Open instance trace */
+	MappedFile trace(trace_file_path);
+
+	if (num_threads == 1) {
+	    MappedCSVReader task_trace(trace.begin() + start_position, trace.end(), trace_file_path);
+	    InstanceRecord r;
+	    while (readInstanceRow(task_trace, r, &filter)) {
+		prepare(r);
+		consume(r);
+		if (lines_read % 10000 == 0 and checkpointDue()) {
+		    saveCheckpoint(task_trace.getPosition() - trace.begin());
+		}
+	    }
+	} else {
+	    /* Parse line-aligned shards in parallel, then replay them in file order */
+	    ShardedTraceReader task_trace(trace, num_threads, shard_size, prepare, &filter);
+	    task_trace.setOffset(start_position);
+	    std::vector<std::vector<InstanceRecord>> shards;
+	    while (task_trace.readBatch(shards)) {
+		for (auto& shard : shards) {
+		    for (auto& r : shard) {
+			consume(r);
+		    }
+		}
+		if (checkpointDue()) {
+		    saveCheckpoint(task_trace.getOffset());
+		}
+	    }
 	}
     }
     
     /* dump remaining jobs */
-    for (auto itj = jobs.begin(); itj != jobs.end(); ++itj) {
-	int is_dumped = dumpJob(itj->second, output_path, time_out);
-	delete itj->second;
-	jobs.erase(itj->first);
-	num_dumped_jobs += is_dumped;
+    for (auto& entry : job_list) {
+	auto itj = jobs.find(entry.first);
+	if (itj == jobs.end() or itj->second.second != entry.second) continue;
+	retireJob(itj, true);
+
+	printProgress(false);
 
-	std::cerr << "Read " << std::setw(10) << (double) lines_read / 1351255775 * 100 << "\% of file...\t"
-		  << "# of queued jobs: " << std::setw(6) << jobs.size() << "\t"
-		  << "# of dumped jobs: " << std::setw(8) << num_dumped_jobs <<"\r";
+    }
+    writer_pool.finish();
+    corpus_index.close();
+    printProgress(true);
 
+    /* The run is complete, a later --resume must not pick this state up */
+    if (not checkpoint_path.empty()) {
+	std::filesystem::remove(checkpoint_path);
     }
-    std::cerr << std::endl;
+
+    std::cerr << "Rejected job filter:\t" << job_out_of_range.getNumInserted() << " jobs in "
+	      << job_out_of_range.getSizeInBytes() / 1024 << " KB, estimated false-positive rate "
+	      << job_out_of_range.getFalsePositiveRate() << std::endl;
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    stats.stage = "workflows";
+    stats.rows_read = lines_read;
+    stats.bytes_written = bytes_written;
+    stats.seconds = elapsed.count();
 
     return 0;
 }
+
+#ifndef TRACE_TO_ALL
+int main(int argc, char **argv) {
+    WorkflowOptions options;
+    if (not parseWorkflowOptions(argc, argv, options)) return 1;
+    MachineMap machines;
+    ConverterStats stats;
+    int result = convertWorkflows(options, machines, stats);
+    printConverterStats(stats);
+    return result;
+}
+#endif
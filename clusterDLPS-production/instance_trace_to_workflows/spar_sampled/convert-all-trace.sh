@@ -1,5 +1,8 @@
 #!/bin/bash
 
+# Samples of the full trace for every machine count, in trace/<N>_sample/
+./trace2samples ../original/trace/batch_instance.csv --threads=`nproc`
+
 for nMachines in 4 8 16 32 64
 do	
     WORKFLOW_DIR="./workflows_without_file_size/${nMachines}_machines"
@@ -1,2 +1,5 @@
+#include <cstdint>
+#include <string_view>
 
 std::vector<std::string> splitString(std::string string_in, std::string delimiter);
+uint64_t hashString(std::string_view string_in);
@@ -0,0 +1,264 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <future>
+#include <filesystem>
+#include <charconv>
+#include <cstdio>
+#include <string.h>
+
+#include "helper/helper.h"
+
+#include "MappedCSVReader.h"
+
+/* Samples of the full trace for clusters of 4, 8, ... 4096 machines */
+const int min_num_machine = 4;
+const int max_num_machine = 4096;
+
+/* Rank of a job in [0, max_num_machine), drawn from a seeded hash of its name. The
+ * sample for N machines keeps the jobs ranked below N, so every job is kept or
+ * dropped as a whole, samples are nested, and each keeps N/4096 of the jobs. */
+static int getJobRank(std::string_view job_name, uint64_t seed) {
+    uint64_t hash = hashString(job_name) + seed * 0x9e3779b97f4a7c15ULL;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    hash = hash ^ (hash >> 31);
+    return hash >> 52;
+}
+
+static std::string getSamplePath(const std::string& output_path, int num_machine) {
+    return output_path + std::to_string(num_machine) + "_sample/batch_instace.csv";
+}
+
+int main(int argc, char **argv) {
+
+    std::string trace_file_path = "../original/trace/batch_instance.csv";
+    std::string output_path = "trace/";
+    uint64_t seed = 0;
+    int num_threads = 1;
+    for (int i = 1; i < argc; i++) {
+	if (strncmp(argv[i], "--seed=", 7) == 0) {
+	    seed = std::strtoull(argv[i] + 7, nullptr, 10);
+	} else if (strncmp(argv[i], "--threads=", 10) == 0) {
+	    num_threads = std::max(1, std::atoi(argv[i] + 10));
+	} else if (strncmp(argv[i], "--output=", 9) == 0) {
+	    output_path = argv[i] + 9;
+	} else if (argv[i][0] != '-') {
+	    trace_file_path = argv[i];
+	} else {
+	    std::cerr << "Usage: " << argv[0] << " [batch_instance.csv] [--output=DIR] [--seed=S] [--threads=N]" << std::endl;
+	    exit(1);
+	}
+    }
+    if (not output_path.empty() and output_path.back() != '/') output_path += '/';
+
+    std::vector<int> num_machines;
+    for (int n = min_num_machine; n <= max_num_machine; n *= 2) {
+	num_machines.push_back(n);
+	std::filesystem::create_directories(output_path + std::to_string(n) + "_sample");
+    }
+    const int num_samples = num_machines.size();
+
+    std::cerr << "Trace file:\t" << trace_file_path << std::endl;
+    std::cerr << "Output Path:\t" << output_path << std::endl;
+    std::cerr << "Seed:\t\t" << seed << std::endl;
+
+    MappedFile trace(trace_file_path);
+
+    /* One line-aligned range of the trace per thread */
+    std::vector<const char*> bounds = {trace.begin()};
+    for (int t = 1; t < num_threads; t++) {
+	const char* position = trace.begin() + trace.getSize() / num_threads * t;
+	position = std::max(position, bounds.back());
+	const char* line_end = static_cast<const char*>(memchr(position, '\n', trace.end() - position));
+	bounds.push_back(line_end ? line_end + 1 : trace.end());
+    }
+    bounds.push_back(trace.end());
+
+    /* First pass: the number of instances of every job, and the jobs with a failed
+     * instance or an unknown start or end time (empty parses as 0). trace2workflows
+     * rejects such a job as a whole, so it is left out of every sample as a whole. */
+    const int num_instance_column = 14;
+    std::vector<std::unordered_map<uint64_t, long>> range_instances(num_threads);
+    std::vector<std::unordered_set<uint64_t>> range_invalid_jobs(num_threads);
+    auto checkRange = [&](int t) {
+	MappedCSVReader reader(bounds[t], bounds[t + 1], trace_file_path);
+	std::string_view fields[num_instance_column];
+	while (reader.readRow(fields, num_instance_column)) {
+	    uint64_t job_hash = hashString(fields[2]);
+	    range_instances[t][job_hash]++;
+	    double start_time;
+	    double end_time;
+	    MappedCSVReader::parse(fields[5], start_time);
+	    MappedCSVReader::parse(fields[6], end_time);
+	    if (fields[4] != "Terminated" or start_time <= 0 or end_time <= 0) {
+		range_invalid_jobs[t].insert(job_hash);
+	    }
+	}
+    };
+
+    std::vector<std::future<void>> workers;
+    for (int t = 0; t < num_threads; t++) {
+	workers.push_back(std::async(std::launch::async, checkRange, t));
+    }
+    for (auto& worker : workers) {
+	worker.get();
+    }
+    std::unordered_map<uint64_t, long> job_instances = std::move(range_instances[0]);
+    std::unordered_set<uint64_t> invalid_jobs = std::move(range_invalid_jobs[0]);
+    for (int t = 1; t < num_threads; t++) {
+	for (auto& it : range_instances[t]) job_instances[it.first] += it.second;
+	invalid_jobs.insert(range_invalid_jobs[t].begin(), range_invalid_jobs[t].end());
+	range_instances[t].clear();
+	range_invalid_jobs[t].clear();
+    }
+    std::cerr << "Dropping " << invalid_jobs.size() << " of " << job_instances.size() << " jobs with an invalid instance." << std::endl;
+
+    /* Each thread writes its range of every sample to a part file of its own.
+     * A row is formatted once and appended to every sample its job falls into. */
+    std::vector<std::vector<long>> rows_written(num_threads, std::vector<long>(num_samples, 0));
+    auto sampleRange = [&](int t) {
+	MappedCSVReader reader(bounds[t], bounds[t + 1], trace_file_path);
+	std::vector<FILE*> parts(num_samples);
+	std::vector<std::string> buffers(num_samples);
+	for (int s = 0; s < num_samples; s++) {
+	    std::string part_path = getSamplePath(output_path, num_machines[s]) + ".part" + std::to_string(t);
+	    parts[s] = fopen(part_path.c_str(), "w");
+	    if (parts[s] == nullptr) {
+		throw std::invalid_argument("Cannot open file for output!");
+	    }
+	}
+	auto flush = [&](int s) {
+	    if (fwrite(buffers[s].data(), 1, buffers[s].size(), parts[s]) != buffers[s].size()) {
+		throw std::invalid_argument("Cannot write file for output!");
+	    }
+	    buffers[s].clear();
+	};
+
+	std::string_view fields[num_instance_column];
+	std::string line;
+	char number[32];
+	while (reader.readRow(fields, num_instance_column)) {
+
+	    if (invalid_jobs.find(hashString(fields[2])) != invalid_jobs.end()) continue;
+	    double start_time;
+	    double end_time;
+	    MappedCSVReader::parse(fields[5], start_time);
+	    MappedCSVReader::parse(fields[6], end_time);
+
+	    int rank = getJobRank(fields[2], seed);
+	    auto result = std::to_chars(number, number + sizeof(number), std::max(end_time - start_time, 0.0));
+
+	    /* start_time,job_name,task_name,instance_name,duration,cpu_avg,mem_avg */
+	    line.assign(fields[5]);
+	    line += ','; line += fields[2];
+	    line += ','; line += fields[1];
+	    line += ','; line += fields[0];
+	    line += '_'; line += fields[8]; // instance names repeat, the sequence number tells them apart
+	    line += ','; line.append(number, result.ptr);
+	    line += ','; line += fields[10];
+	    line += ','; line += fields[12];
+	    line += '\n';
+
+	    for (int s = num_samples - 1; s >= 0 and rank < num_machines[s]; s--) {
+		buffers[s] += line;
+		rows_written[t][s]++;
+		if (buffers[s].size() >= (1 << 20)) flush(s);
+	    }
+	}
+	for (int s = 0; s < num_samples; s++) {
+	    flush(s);
+	    if (fclose(parts[s]) != 0) {
+		throw std::invalid_argument("Cannot write file for output!");
+	    }
+	}
+    };
+
+    workers.clear();
+    for (int t = 0; t < num_threads; t++) {
+	workers.push_back(std::async(std::launch::async, sampleRange, t));
+    }
+    for (auto& worker : workers) {
+	worker.get();
+    }
+
+    /* Stitch the parts of every sample together in file order, one sample per thread */
+    auto concatenateParts = [&](int s) {
+	std::string sample_path = getSamplePath(output_path, num_machines[s]);
+	std::filesystem::rename(sample_path + ".part0", sample_path);
+	FILE* sample = fopen(sample_path.c_str(), "a");
+	if (sample == nullptr) {
+	    throw std::invalid_argument("Cannot open file for output!");
+	}
+	std::vector<char> buffer(1 << 20);
+	for (int t = 1; t < num_threads; t++) {
+	    std::string part_path = sample_path + ".part" + std::to_string(t);
+	    FILE* part = fopen(part_path.c_str(), "r");
+	    size_t size;
+	    while (part and (size = fread(buffer.data(), 1, buffer.size(), part)) > 0) {
+		if (fwrite(buffer.data(), 1, size, sample) != size) {
+		    throw std::invalid_argument("Cannot write file for output!");
+		}
+	    }
+	    if (part == nullptr or ferror(part)) {
+		throw std::invalid_argument("Cannot read " + part_path);
+	    }
+	    fclose(part);
+	    std::filesystem::remove(part_path);
+	}
+	if (fclose(sample) != 0) {
+	    throw std::invalid_argument("Cannot write file for output!");
+	}
+    };
+
+    workers.clear();
+    for (int s = 0; s < num_samples; s++) {
+	workers.push_back(std::async(std::launch::async, concatenateParts, s));
+    }
+    for (auto& worker : workers) {
+	worker.get();
+    }
+
+    /* Read every sample back: each of its jobs must have all of its instances */
+    std::vector<long> partial_jobs(num_samples, 0);
+    auto checkSample = [&](int s) {
+	std::string sample_path = getSamplePath(output_path, num_machines[s]);
+	MappedFile sample(sample_path);
+	MappedCSVReader reader(sample.begin(), sample.end(), sample_path);
+	const int num_sample_column = 7;
+	std::string_view fields[num_sample_column];
+	std::unordered_map<uint64_t, long> sample_instances;
+	while (reader.readRow(fields, num_sample_column)) {
+	    sample_instances[hashString(fields[1])]++;
+	}
+	for (auto& it : sample_instances) {
+	    auto itj = job_instances.find(it.first);
+	    if (itj == job_instances.end() or it.second != itj->second) partial_jobs[s]++;
+	}
+    };
+
+    workers.clear();
+    for (int s = 0; s < num_samples; s++) {
+	workers.push_back(std::async(std::launch::async, checkSample, s));
+    }
+    for (auto& worker : workers) {
+	worker.get();
+    }
+
+    int result = 0;
+    for (int s = 0; s < num_samples; s++) {
+	long rows = 0;
+	for (int t = 0; t < num_threads; t++) rows += rows_written[t][s];
+	std::cerr << std::setw(4) << num_machines[s] << " machines:\t" << rows << " rows";
+	if (partial_jobs[s] > 0) {
+	    std::cerr << ", " << partial_jobs[s] << " jobs without all of their instances";
+	    result = 1;
+	}
+	std::cerr << std::endl;
+    }
+
+    return result;
+}
@@ -7,6 +7,7 @@
 #include <nlohmann/json.hpp>
 #include <math.h>
 #include <time.h>
+#include <string.h>
 
 #include <wrench-dev.h>
 #include <wrench/util/UnitParser.h>
@@ -15,8 +16,11 @@
 #include "helper/helper.h"
 
 #include "AlibabaJob.h"
+#include "ColumnarTrace.h"
+#include "InstanceJitter.h"
+#include "CorpusIndex.h"
 
-int dumpJob(AlibabaJob* job, std::string output_path, double time_out) {
+int dumpJob(AlibabaJob* job, std::string output_path, double time_out, CorpusIndex& corpus_index) {
     double this_time_out = time_out;
     time_t rawtime;
     struct tm* timeinfo;
@@ -110,7 +114,9 @@ int dumpJob(AlibabaJob* job, std::string output_path, double time_out) {
  *     j_workflow["machines"] = j_machines; */
 
     nlohmann::json j_jobs = nlohmann::json::array();
+    double total_runtime = 0;
     for (auto itt = tasks.begin(); itt != tasks.end(); ++itt) {
+	total_runtime += itt->second->getFlops();
 	nlohmann::json j_job = nlohmann::json::object();
 	j_job["name"] = itt->first;
 	j_job["type"] = "compute";
@@ -157,23 +163,32 @@ int dumpJob(AlibabaJob* job, std::string output_path, double time_out) {
     j["workflow"] = j_workflow;
 
     /* Write a JSON file for each workflow*/
+    std::string text = j.dump(4);
     std::ofstream file;
     file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
     try {
 	file.open(output_path + job->getName() + ".json");
-	file << j.dump(4);
+	file << text;
 	file.close();
     } catch (const std::ofstream::failure &e) {
 	throw std::invalid_argument("Cannot open file for output!");
     }
 
+    corpus_index.add(output_path, {job->getName() + ".json", job->getSubmittedTime(), (long) tasks.size(), total_runtime, text.size()});
+
     return 1;
 }
 
 int main(int argc, char **argv) {
 
-    if (argc != 3) {
-	std::cerr << "Usage: " << argv[0] << "<number of machines> <time out in seconds>" << std::endl;
+    bool columnar = false;
+    bool legacy_jitter = false;
+    for (int i = 3; i < argc; i++) {
+	columnar = strcmp(argv[i], "--columnar") ? columnar : true;
+	legacy_jitter = strcmp(argv[i], "--legacy-jitter") ? legacy_jitter : true;
+    }
+    if (argc < 3 || argc != 3 + columnar + legacy_jitter) {
+	std::cerr << "Usage: " << argv[0] << "<number of machines> <time out in seconds> [--columnar] [--legacy-jitter]" << std::endl;
 	exit(1);
     }
     
@@ -199,9 +214,7 @@ int main(int argc, char **argv) {
     const int num_task_column = 7;
     const int num_instance_column = 7;
 
-    /* Open instance trace */
-    io::CSVReader<num_task_column> task_trace(
-	    "trace/" + std::to_string(num_machine) + "_sample/batch_instace.csv");
+    std::string trace_file_path = "trace/" + std::to_string(num_machine) + "_sample/batch_instace";
     
     double start_time;
     std::string job_name;
@@ -214,17 +227,18 @@ int main(int argc, char **argv) {
     /* Initiate a map of workflows (jobs) as <jobID, workflow>*/
     std::map<std::string, AlibabaJob*> jobs;
 
-    while (task_trace.read_row(start_time, job_name, task_name, instance_name, duration, avg_cpu, avg_mem)) {
+    /* Add the current instance; its start time and duration are randomized here unless the caller did already */
+    auto addInstance = [&](bool jittered) {
 
-	/* randomize start time and duration */
-	std::mt19937 rng;
-    	std::seed_seq seed (instance_name.begin(), instance_name.end());
-    	rng.seed(seed);
-    	std::uniform_real_distribution<double> dist1(start_time + duration, start_time + duration + 1);
-        double end_time = max(dist1(rng), 0.0);
-    	std::uniform_real_distribution<double> dist2(start_time, min(start_time + 1, end_time));
-	start_time = max(dist2(rng), 0.0);
-	duration = max(end_time - start_time, 0.0);
+	if (not jittered) {
+	    double end_time = start_time + duration;
+	    if (legacy_jitter) {
+		jitterTimesLegacy(instance_name, start_time, end_time);
+	    } else {
+		jitterTimes(hashString(instance_name), start_time, end_time);
+	    }
+	    duration = max(end_time - start_time, 0.0);
+	}
 
 	if (jobs.empty() || jobs.find(job_name) == jobs.end()) { /* a new job */
 	    AlibabaJob* job = new AlibabaJob();
@@ -234,13 +248,67 @@ int main(int argc, char **argv) {
 	} else { /* existing job */
 	    jobs[job_name] = jobs[job_name]->updateJob(task_name, instance_name, start_time, duration, avg_cpu, avg_mem);
 	}
+    };
+
+    if (columnar) {
+	/* Columnar copy written by trace2columnar sample_instance */
+	ColumnarTrace task_trace(trace_file_path + ".col");
+	const double* start_times = task_trace.getDoubles(task_trace.findColumn("start_time"));
+	int job_column = task_trace.findColumn("job_name");
+	int task_column = task_trace.findColumn("task_name");
+	int instance_column = task_trace.findColumn("instance_name");
+	const double* durations = task_trace.getDoubles(task_trace.findColumn("duration"));
+	const double* avg_cpus = task_trace.getDoubles(task_trace.findColumn("cpu_avg"));
+	const double* avg_mems = task_trace.getDoubles(task_trace.findColumn("mem_avg"));
+
+	/* Randomize the times of a row group at once, then add its instances */
+	std::vector<uint64_t> name_hashes;
+	std::vector<double> group_start_times;
+	std::vector<double> group_end_times;
+	for (uint64_t group = 0; group < task_trace.getNumRowGroups(); group++) {
+	    ColumnarRowGroup rows = task_trace.getRowGroup(group);
+	    if (not legacy_jitter) {
+		name_hashes.clear();
+		group_start_times.assign(start_times + rows.begin, start_times + rows.end);
+		group_end_times.clear();
+		for (uint64_t row = rows.begin; row < rows.end; row++) {
+		    name_hashes.push_back(hashString(task_trace.getString(instance_column, row)));
+		    group_end_times.push_back(start_times[row] + durations[row]);
+		}
+		jitterTimes(name_hashes.data(), group_start_times.data(), group_end_times.data(), rows.end - rows.begin);
+	    }
+
+	    for (uint64_t row = rows.begin; row < rows.end; row++) {
+		start_time = start_times[row];
+		job_name.assign(task_trace.getString(job_column, row));
+		task_name.assign(task_trace.getString(task_column, row));
+		instance_name.assign(task_trace.getString(instance_column, row));
+		duration = durations[row];
+		avg_cpu = avg_cpus[row];
+		avg_mem = avg_mems[row];
+		if (not legacy_jitter) {
+		    start_time = group_start_times[row - rows.begin];
+		    duration = max(group_end_times[row - rows.begin] - start_time, 0.0);
+		}
+		addInstance(not legacy_jitter);
+	    }
+	}
+    } else {
+	/* Open instance trace */
+	io::CSVReader<num_task_column> task_trace(trace_file_path + ".csv");
+
+	while (task_trace.read_row(start_time, job_name, task_name, instance_name, duration, avg_cpu, avg_mem)) {
+	    addInstance(false);
+	}
     }
     
     long num_skipped = 0;
+    CorpusIndex corpus_index;
     for (auto itj = jobs.begin(); itj != jobs.end(); ++itj) {
-	int is_dumped = dumpJob(itj->second, output_path, time_out);
+	int is_dumped = dumpJob(itj->second, output_path, time_out, corpus_index);
         if (not is_dumped) { num_skipped++; }
     }
+    corpus_index.close();
 
     std::cerr << "Skipped " << std::to_string(num_skipped) << "/" << std::to_string(jobs.size()) << " = " << std::to_string((double) num_skipped/jobs.size()*100) << "% jobs." << std::endl;
     return 0;